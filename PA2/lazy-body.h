@@ -0,0 +1,50 @@
+#ifndef LAZY_BODY_H
+#define LAZY_BODY_H
+//////////////////////////////////////////////////////////////////////
+//
+//  lazy-body.h
+//
+//  Lazy parsing of method bodies and attribute initializers, for
+//  coolc -L.  The inheritance graph, the class table and the method
+//  tables only need the signatures of the features, so the scanner can
+//  skip over the bodies: at the outermost level of a class, a '{'
+//  (which can only open a method body) is matched with its '}', and a
+//  `<-' (which can only start an initializer) with the next ';' outside
+//  braces and case ... esac.  The tokens in between are scanned to find
+//  the end but never reach the parser.  The parser gets a single
+//  LAZY_EXPR token instead, whose value is a placeholder no_expr that
+//  stands for the body, and the scanner remembers where in the mapped
+//  file the body's text is.
+//
+//  parse_lazy_body() parses the text of a placeholder on demand: the
+//  scanner is restarted on that part of the file and the parser is
+//  started at EXPR_START, which makes it accept a single expression.
+//  A body that is never asked for is never parsed, type checked or
+//  given real code; its feature keeps the placeholder, which semant
+//  and cgen treat like the no_expr bodies of the basic classes.  Syntax
+//  errors in such a body are therefore not reported.  A body with a
+//  lexical error is not skipped at all, and neither is the rest of its
+//  file, so lexical errors are reported as without -L.
+//
+//  Only regular files, which the scanner maps, are scanned lazily, and
+//  their mappings are kept until the compiler exits.  The scanner does
+//  all this only when built with -DLAZY_BODIES (coolc's cool-lex.o);
+//  the stand-alone lexer of PA2 does not know about the extra tokens.
+//  Their numbers are bison's: the scanner takes them from the cool.tab.h
+//  generated from cool.y.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "cool-tree.h"
+
+extern int lazy_bodies;         // -L: skip bodies while scanning
+extern Expression body_result;  // set by the parser after EXPR_START
+
+//
+// If e is a placeholder, parse the body it stands for and return it
+// (or e itself if the body has syntax errors, which are counted in
+// omerrs); any other expression is returned as it is.
+//
+Expression parse_lazy_body(Expression e);
+
+#endif
@@ -12,12 +12,18 @@
 //
 //  Option -l prints summary of flex actions.
 //
+//  Option -b writes the tokens in the binary format of token-stream.h
+//  instead of one line of text per token.  Text that the scanner's
+//  default rule echoes then goes to stderr, not into the stream.
+//
 //////////////////////////////////////////////////////////////////////////////
 
 #include <stdio.h>      // needed on Linux system
 #include <unistd.h>     // for getopt
 #include "cool-parse.h" // bison-generated file; defines tokens
 #include "utilities.h"
+#include "token-stream.h"
+#include "token-batch.h"
 
 //
 //  The lexer keeps this global variable up to date with the line number
@@ -28,10 +34,10 @@ char *curr_filename = "<stdin>"; // this name is arbitrary
 FILE *fin;   // This is the file pointer from which the lexer reads its input.
 
 //
-//  cool_yylex() is the function produced by flex. It returns the next
-//  token each time it is called.
+//  cool_lex_batch() (token-batch.h) runs the scanner produced by flex
+//  and returns the next batch of tokens each time it is called.
 //
-extern int cool_yylex();
+extern void cool_lex_file(FILE *);  // points the scanner at a new file
 YYSTYPE cool_yylval;           // Not compiled with parser, so must define this.
 
 extern int optind;  // used for option processing (man 3 getopt for more info)
@@ -42,6 +48,8 @@ extern int optind;  // used for option processing (man 3 getopt for more info)
 //
 extern int yy_flex_debug;      // Flex debugging; see flex documentation.
 extern int lex_verbose;        // Controls printing of tokens.
+extern int token_binary;       // Option -b: write a binary token stream.
+extern FILE *yyout;            // where flex's default rule echoes text
 void handle_flags(int argc, char *argv[]);
 
 //
@@ -58,9 +66,15 @@ extern void dump_cool_token(ostream& out, int lineno,
 
 
 int main(int argc, char** argv) {
-	int token;
+	static TokenBatch batch;
+	TokenWriter *writer = NULL;
 	
 	handle_flags(argc,argv);
+	if (token_binary) {
+	    writer = new TokenWriter(stdout);
+	    // keep echoed text out of the binary stream
+	    yyout = stderr;
+	}
 
 	while (optind < argc) {
 	    fin = fopen(argv[optind], "r");
@@ -73,13 +87,25 @@ int main(int argc, char** argv) {
             // this counter, so let's make the stand-alone lexer
             // do the same thing
             curr_lineno = 1;
+	    cool_lex_file(fin);
 
 	    //
 	    // Scan and print all tokens.
 	    //
-	    cout << "#name \"" << argv[optind] << "\"" << endl;
-	    while ((token = cool_yylex()) != 0) {
-		dump_cool_token(cout, curr_lineno, token, cool_yylval);
+	    if (writer)
+		writer->file(argv[optind]);
+	    else
+		cout << "#name \"" << argv[optind] << "\"" << endl;
+	    while (cool_lex_batch(batch) != 0) {
+		for (int i = 0; i < batch.count; i++) {
+		    if (writer) {
+			writer->token(batch.lineno[i], batch.token[i], batch.value[i]);
+		    } else {
+			// dump_cool_token prints the global cool_yylval
+			cool_yylval = batch.value[i];
+			dump_cool_token(cout, batch.lineno[i], batch.token[i], cool_yylval);
+		    }
+		}
 	    }
 	    fclose(fin);
 	    optind++;
@@ -0,0 +1,147 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////
+//
+//  relex.cc
+//
+//  LexSession, the incremental re-lexer described in relex.h.  The
+//  scanning itself is done by cool.flex through cool_lex_resume and
+//  cool_lex_next.
+//
+//////////////////////////////////////////////////////////////////
+
+#include "relex.h"
+
+//
+// Every rule of cool.flex that returns a token leaves the scanner in
+// the INITIAL start condition (0) outside any comment, except for the
+// error at the end of an unterminated comment, after which nothing
+// follows.  Old tokens therefore all ended in that state, and a new
+// token lines up with an old one only if it ends in that state too.
+//
+#define RESYNC_START 0
+
+LexSession::LexSession()
+{
+  m_text.resize(2, '\0');
+}
+
+//
+// Scan from `from' to the end of the text, appending the tokens to
+// `out' and a checkpoint every LEX_CHECKPOINT_INTERVAL tokens.  The
+// first token scanned gets index `first'.  Once a token ends at or
+// after `edit_end' exactly where an old token ended (shifted by
+// `delta'), the scan stops and *resync is set to that old token's
+// index; it stays -1 if the end of the text comes first.
+//
+void LexSession::scan(const LexState& from, std::vector<LexToken>& out,
+                      int first, size_t edit_end, long delta, int *resync)
+{
+  LexState st = from;
+  LexToken tok;
+  size_t k = first;
+
+  *resync = -1;
+  cool_lex_resume(&m_text[0], length(), st);
+  while (cool_lex_next(tok, st) != 0) {
+    out.push_back(tok);
+
+    int n = first + out.size();
+    if (n % LEX_CHECKPOINT_INTERVAL == 0) {
+      Checkpoint cp = { n, st };
+      m_checkpoints.push_back(cp);
+    }
+
+    if (tok.end < edit_end || st.start != RESYNC_START || st.comment_level != 0)
+      continue;
+    while (k < m_tokens.size() && (long) m_tokens[k].end + delta < (long) tok.end)
+      k++;
+    if (k < m_tokens.size() && (long) m_tokens[k].end + delta == (long) tok.end) {
+      *resync = k;
+      return;
+    }
+  }
+}
+
+void LexSession::lex(const char *text, size_t len)
+{
+  LexState st = { 0, RESYNC_START, 0, 1 };
+  Checkpoint start = { 0, st };
+  int resync;
+
+  m_text.assign(text, text + len);
+  m_text.push_back('\0');
+  m_text.push_back('\0');
+  m_tokens.clear();
+  m_checkpoints.clear();
+  m_checkpoints.push_back(start);
+
+  std::vector<LexToken> tokens;
+  scan(st, tokens, 0, (size_t) -1, 0, &resync);
+  m_tokens.swap(tokens);
+}
+
+TokenDelta LexSession::edit(size_t offset, size_t removed, const char *text, size_t len)
+{
+  TokenDelta d;
+  long delta = (long) len - (long) removed;
+  int resync;
+
+  if (offset > length())
+    offset = length();
+  if (removed > length() - offset)
+    removed = length() - offset;
+
+  //
+  // Restart from the last checkpoint before the edit.  A token ending
+  // right at the edit may have looked at the edited character to decide
+  // where it ends, so the checkpoint has to lie strictly before it.
+  //
+  int c = m_checkpoints.size() - 1;
+  while (c > 0 && m_checkpoints[c].state.offset >= offset)
+    c--;
+  Checkpoint from = m_checkpoints[c];
+  std::vector<Checkpoint> tail(m_checkpoints.begin() + c + 1, m_checkpoints.end());
+  m_checkpoints.resize(c + 1);
+
+  m_text.erase(m_text.begin() + offset, m_text.begin() + offset + removed);
+  m_text.insert(m_text.begin() + offset, text, text + len);
+
+  scan(from.state, d.inserted, from.ntokens, offset + len, delta, &resync);
+
+  d.first = from.ntokens;
+  d.offset_delta = delta;
+  if (resync < 0) {
+    d.removed = m_tokens.size() - d.first;
+    d.line_delta = 0;
+  } else {
+    d.removed = resync + 1 - d.first;
+    d.line_delta = d.inserted.back().lineno - m_tokens[resync].lineno;
+  }
+
+  //
+  // Bring the session's tokens and checkpoints up to date: everything
+  // after the replaced tokens only moves.
+  //
+  for (size_t i = d.first + d.removed; i < m_tokens.size(); i++) {
+    m_tokens[i].end += delta;
+    m_tokens[i].lineno += d.line_delta;
+  }
+  m_tokens.erase(m_tokens.begin() + d.first, m_tokens.begin() + d.first + d.removed);
+  m_tokens.insert(m_tokens.begin() + d.first, d.inserted.begin(), d.inserted.end());
+
+  int moved = (int) d.inserted.size() - d.removed;
+  for (size_t i = 0; resync >= 0 && i < tail.size(); i++) {
+    if (tail[i].ntokens <= resync + 1)
+      continue;
+    tail[i].ntokens += moved;
+    tail[i].state.offset += delta;
+    tail[i].state.lineno += d.line_delta;
+    m_checkpoints.push_back(tail[i]);
+  }
+  return d;
+}
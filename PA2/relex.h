@@ -0,0 +1,101 @@
+#ifndef RELEX_H
+#define RELEX_H
+//////////////////////////////////////////////////////////////////////
+//
+//  relex.h
+//
+//  Incremental re-lexing for editors and watch mode.  A LexSession
+//  keeps the source text, its tokens and a checkpoint of the scanner
+//  state every LEX_CHECKPOINT_INTERVAL tokens.  After an edit it
+//  re-lexes from the last checkpoint before the edit and stops as soon
+//  as the new tokens line up with the old ones again, returning only
+//  the tokens that changed.
+//
+//  The new stream has caught up with the old one once a new token ends
+//  past the edited text at the (shifted) end of an old token, with the
+//  scanner in the same state.  From there on the scanner sees the same
+//  state and the same input as before, so it would produce the same
+//  tokens.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <stddef.h>
+#include <vector>
+#include "cool-parse.h"
+
+#define LEX_CHECKPOINT_INTERVAL 64
+
+//
+// Scanner state between two tokens: the flex start condition, the
+// nesting depth of (* *) comments, the line number and the byte offset
+// in the text.
+//
+struct LexState {
+    size_t offset;
+    int start;
+    int comment_level;
+    int lineno;
+};
+
+//
+// A token as cool_yylex would return it, plus the offset just past its
+// last character.
+//
+struct LexToken {
+    int token;
+    int lineno;
+    size_t end;
+    YYSTYPE value;
+};
+
+//
+// The old tokens [first, first + removed) are replaced by `inserted';
+// the tokens after them move by line_delta lines and offset_delta
+// bytes.
+//
+struct TokenDelta {
+    int first;
+    int removed;
+    std::vector<LexToken> inserted;
+    int line_delta;
+    long offset_delta;
+};
+
+class LexSession {
+private:
+    struct Checkpoint {
+        int ntokens;            // tokens before this point
+        LexState state;
+    };
+
+    std::vector<char> m_text;   // the source followed by two NULs
+    std::vector<LexToken> m_tokens;
+    std::vector<Checkpoint> m_checkpoints;
+
+    size_t length() const { return m_text.size() - 2; }
+    void scan(const LexState& from, std::vector<LexToken>& out,
+              int first, size_t edit_end, long delta,
+              int *resync);
+
+public:
+    LexSession();
+
+    // Lex `text' from scratch.
+    void lex(const char *text, size_t len);
+
+    // Replace `removed' bytes at `offset' by text[0..len) and re-lex.
+    TokenDelta edit(size_t offset, size_t removed, const char *text, size_t len);
+
+    const std::vector<LexToken>& tokens() const { return m_tokens; }
+};
+
+//
+// Scanner hooks in cool.flex.  cool_lex_resume points the scanner at
+// base[0..len), which must be followed by two NULs, in state `st';
+// cool_lex_next then returns the tokens one at a time (0 at the end)
+// and leaves the state after each of them in `st'.
+//
+void cool_lex_resume(char *base, size_t len, const LexState& st);
+int cool_lex_next(LexToken& tok, LexState& st);
+
+#endif
@@ -0,0 +1,201 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//  relextest.cc
+//
+//  Checks the incremental re-lexer of relex.h against lexing from
+//  scratch.  Each file argument is lexed by a LexSession and then
+//  edited a few hundred times at pseudo-random places, with snippets
+//  chosen to open and close strings, comments and tokens, and each
+//  edit is undone again afterwards.  After every edit (and every undo)
+//  three token lists have to agree: the old tokens with the
+//  TokenDelta applied, the session's tokens, and the tokens of a new
+//  session that lexes the edited text from scratch.
+//
+//  Option -n sets the number of edits per file (default 500).
+//
+//  Prints one line per file and exits with status 1 on the first
+//  mismatch, after printing the edit and both versions of the token.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>     // for getopt
+#include <string>
+#include <vector>
+#include "cool-parse.h"
+#include "utilities.h"
+#include "relex.h"
+
+int curr_lineno = 1;
+char *curr_filename = "<stdin>";
+FILE *fin;              // read by the scanner's YY_INPUT; unused here
+YYSTYPE cool_yylval;    // not compiled with the parser
+
+extern FILE *yyout;     // where the scanner's default rule echoes
+
+static const std::string snippets[] = {
+    "", " ", "\n", "\t", "x", "Int", "class", "else", "<-", "=>", "<=",
+    "123", "\"", "\"ab\"", "\\", "\\\n", "(*", "*)", "(* c *)", "--",
+    "-- c\n", "(", "*", ")", ";", "{", "}", "@", "#", std::string(1, '\0'),
+};
+#define NSNIPPETS (int) (sizeof(snippets) / sizeof(snippets[0]))
+
+//
+// A small deterministic generator, so that a failure can be rerun.
+//
+static unsigned long seed = 1;
+
+static unsigned next(unsigned n)
+{
+    seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+    return (unsigned) (seed >> 33) % n;
+}
+
+static bool same_token(const LexToken& a, const LexToken& b)
+{
+    if (a.token != b.token || a.lineno != b.lineno || a.end != b.end)
+	return false;
+    switch (a.token) {
+    case STR_CONST: case INT_CONST: case TYPEID: case OBJECTID:
+	return a.value.symbol == b.value.symbol;
+    case BOOL_CONST:
+	return a.value.boolean == b.value.boolean;
+    case ERROR:
+	return strcmp(a.value.error_msg, b.value.error_msg) == 0;
+    default:
+	return true;
+    }
+}
+
+static void print_token(const char *what, const LexToken& t)
+{
+    cout << "  " << what << " (end " << t.end << "): ";
+    // dump_cool_token prints the global cool_yylval
+    cool_yylval = t.value;
+    dump_cool_token(cout, t.lineno, t.token, cool_yylval);
+}
+
+//
+// Compare two token lists; on a mismatch print where and return false.
+//
+static bool same_tokens(const char *what, const std::vector<LexToken>& a,
+                        const std::vector<LexToken>& b)
+{
+    size_t i = 0;
+
+    while (i < a.size() && i < b.size() && same_token(a[i], b[i]))
+	i++;
+    if (i == a.size() && i == b.size())
+	return true;
+    cout << "  " << what << ": token " << i << " differs" << endl;
+    if (i < a.size())
+	print_token("expected", a[i]);
+    else
+	cout << "  expected: end of tokens" << endl;
+    if (i < b.size())
+	print_token("got", b[i]);
+    else
+	cout << "  got: end of tokens" << endl;
+    return false;
+}
+
+//
+// Replace `removed' bytes at `offset' by s, in the session and in text,
+// and check the tokens; on a mismatch print the edit and return false.
+//
+static bool check_edit(const char *name, LexSession& session, std::string& text,
+                       size_t offset, size_t removed, const std::string& s)
+{
+    std::vector<LexToken> old = session.tokens();
+    TokenDelta d = session.edit(offset, removed, s.data(), s.size());
+    text.replace(offset, removed, s);
+
+    std::vector<LexToken> applied(old.begin(), old.begin() + d.first);
+    applied.insert(applied.end(), d.inserted.begin(), d.inserted.end());
+    for (size_t i = d.first + d.removed; i < old.size(); i++) {
+	LexToken t = old[i];
+	t.end += d.offset_delta;
+	t.lineno += d.line_delta;
+	applied.push_back(t);
+    }
+
+    LexSession fresh;
+    fresh.lex(text.data(), text.size());
+
+    if (same_tokens("delta", fresh.tokens(), applied) &&
+	same_tokens("session", fresh.tokens(), session.tokens()))
+	return true;
+    cout << name << ": edit at " << offset << " removing " << removed
+	 << " bytes, inserting \"";
+    for (size_t i = 0; i < s.size(); i++)
+	if (s[i] == '\0')
+	    cout << "\\000";
+	else
+	    print_escaped_string(cout, s.substr(i, 1).c_str());
+    cout << "\": FAILED" << endl;
+    return false;
+}
+
+static bool check_file(const char *name, int edits)
+{
+    FILE *f = fopen(name, "r");
+    if (f == NULL) {
+	cerr << "Could not open input file " << name << endl;
+	exit(1);
+    }
+    std::string text;
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof buf, f)) > 0)
+	text.append(buf, n);
+    fclose(f);
+
+    LexSession session;
+    session.lex(text.data(), text.size());
+
+    for (int e = 0; e < edits; e++) {
+	size_t offset = next(text.size() + 1);
+	size_t removed = next(9);
+	if (removed > text.size() - offset)
+	    removed = text.size() - offset;
+	const std::string& s = snippets[next(NSNIPPETS)];
+	std::string undo = text.substr(offset, removed);
+
+	if (!check_edit(name, session, text, offset, removed, s) ||
+	    !check_edit(name, session, text, offset, s.size(), undo))
+	    return false;
+    }
+    cout << name << ": " << edits << " edits, " << session.tokens().size()
+	 << " tokens, ok" << endl;
+    return true;
+}
+
+int main(int argc, char** argv) {
+	int edits = 500;
+	int c;
+
+	while ((c = getopt(argc, argv, "n:")) != -1) {
+	    if (c == 'n')
+		edits = atoi(optarg);
+	    else {
+		cerr << "usage: " << argv[0] << " [-n edits] file ..." << endl;
+		exit(1);
+	    }
+	}
+
+	// the default rule's echoes are of no interest here
+	yyout = fopen("/dev/null", "w");
+
+	for (; optind < argc; optind++)
+	    if (!check_file(argv[optind], edits))
+		exit(1);
+	exit(0);
+}
@@ -0,0 +1,236 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#ifndef _STRINGTAB_H_
+#define _STRINGTAB_H_
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <mutex>
+#include <unordered_map>
+
+#include "list.h" // list template
+#include "cool-io.h"
+
+class Entry;
+typedef Entry* Symbol;
+
+extern ostream& operator<<(ostream& s, const Entry& sym);
+extern ostream& operator<<(ostream& s, Symbol sym);
+
+//
+// The hash of the first len characters of s (FNV-1a).  Every Entry
+// keeps the hash of its string so that the string tables can find and
+// compare entries without touching the characters.
+//
+unsigned int hash_string(char *s, int len);
+
+/////////////////////////////////////////////////////////////////////////
+//
+//  String Table Entries
+//
+/////////////////////////////////////////////////////////////////////////
+
+class Entry {
+protected:
+  char *str;     // the string
+  int  len;      // the length of the string (without trailing \0)
+  int index;     // a unique index for each string
+  unsigned int hash;  // hash_string(str, len)
+public:
+  // s is not copied: it must hold l characters and a '\0' and live
+  // as long as the Entry.  StringTable keeps it in its arena, or in a
+  // mapped snapshot.  h is hash_string(s, l).
+  Entry(char *s, int l, int i, unsigned int h);
+
+  // is string argument equal to the str of this Entry?
+  int equal_string(char *s, int len) const;
+  // the same, for a string whose hash is already known
+  int equal_string(char *s, int len, unsigned int h) const;
+
+  // is the integer argument equal to the index of this Entry?
+  bool equal_index(int ind) const           { return ind == index; }
+
+  ostream& print(ostream& s) const;
+
+  // Return the str and len components of the Entry.
+  char *get_string() const;
+  int get_len() const;
+  unsigned int get_hash() const             { return hash; }
+};
+
+//
+// There are three kinds of string table entries:
+//   a true string, an string representation of an identifier, and
+//   a string representation of an integer.
+//
+// Having separate tables is convenient for code generation.  Different
+// data definitions are generated for string constants (StringEntry) and
+// integer  constants (IntEntry).  Identifiers (IdEntry) don't produce
+// static data definitions.
+//
+// code_def and code_ref are used by the code to produce definitions and
+// references (respectively) to constants.
+//
+class StringEntry : public Entry {
+public:
+  void code_def(ostream& str, int stringclasstag);
+  void code_ref(ostream& str);
+  StringEntry(char *s, int l, int, unsigned int);
+};
+
+class IdEntry : public Entry {
+public:
+  IdEntry(char *s, int l, int, unsigned int);
+};
+
+//
+// An IntEntry also holds the value of its string, parsed once when it
+// is interned.  Spellings of the same number ("007" and "7") are still
+// different entries, so that the lexer and the AST show the constant as
+// written, but IntTable points all of them at the first one (`canon'),
+// and only that one gets an int_const in the generated code.
+//
+class IntEntry: public Entry {
+protected:
+  int value;         // the value of str, if has_value()
+  bool exact;        // str is a decimal number that fits in an int
+  IntEntry *canon;   // the entry whose int_const stands for this one
+  friend class IntTable;
+public:
+  void code_def(ostream& str, int intclasstag);
+  void code_ref(ostream &str);
+  IntEntry(char *s, int l, int, unsigned int);
+
+  int get_value() const                     { return value; }
+  bool has_value() const                    { return exact; }
+  IntEntry *get_canon() const               { return canon; }
+};
+
+typedef StringEntry* StringEntryP;
+typedef IdEntry* IdEntryP;
+typedef IntEntry* IntEntryP;
+
+//////////////////////////////////////////////////////////////////////////
+//
+//  String Tables
+//
+//////////////////////////////////////////////////////////////////////////
+
+//
+// A bump pointer allocator.  Each string table carves its entries, the
+// list cells that chain them and their characters out of one arena, so
+// an entry sits next to its string and to the entries interned around
+// it.  Nothing is ever freed: entries live as long as the compilation.
+//
+class StringArena {
+private:
+   char *next;        // free space in the current block
+   char *end;
+public:
+   StringArena(): next((char *) NULL), end((char *) NULL) { }
+   void *alloc(size_t size);
+};
+
+//
+// The hash index of a string table is split into STRTAB_SHARDS shards
+// by the top bits of the hash, each with its own lock, so that threads
+// interning different strings rarely wait for each other.
+//
+#define STRTAB_SHARDS 16
+
+template <class Elem>
+class StringTable
+{
+protected:
+   struct Shard {
+      std::mutex lock;
+      Elem **slots;      // open addressing hash index over the entries
+      int nslots;        // size of slots, 0 or a power of two
+      int count;         // entries in the shard
+
+      Shard(): slots((Elem **) NULL), nslots(0), count(0) { }
+      Elem **find_slot(char *s, int len, unsigned int h);
+      void grow();
+   };
+
+   List<Elem> *tbl;   // a string table is a list
+   int index;         // the current index
+   Shard shards[STRTAB_SHARDS];
+   std::mutex alloc_lock; // guards tbl, index and arena
+   StringArena arena; // storage for the entries and their strings
+
+   Elem *intern(char *s, int len, unsigned int h, bool copy);
+   // called with alloc_lock held for every new entry
+   virtual void added(Elem *e) { }
+public:
+   StringTable(): tbl((List<Elem> *) NULL), index(0) { }   // an empty table
+   // The following methods each add a string to the string table.
+   // Only one copy of each string is maintained.
+   // Returns a pointer to the Entry for the string in the table.
+   //
+   // add_string and lookup_string may be called from several threads
+   // at once; a string still gets exactly one Entry.  The iterator,
+   // lookup and print are for after the tables have been filled.
+   Elem *add_string(char *s, int maxchars);
+   Elem *add_string(char *s);
+   Elem *add_int(int i);
+   // Add s[0..len), whose hash is h, without copying it: the
+   // characters must stay put for the rest of the compilation.
+   Elem *add_mapped(char *s, int len, unsigned int h);
+
+   // The following define an iterator for the string table.
+   int first();       // first index
+   int more(int i);   // are there more indices?
+   int next(int i);   // next index
+
+   Elem *lookup(int index);      // lookup an element using its index
+   Elem *lookup_string(char *s); // lookup an element using its string
+
+   void print();  // print the entire table; for debugging
+   void write(FILE *f);  // the entries in a snapshot, see below
+
+};
+
+class IdTable : public StringTable<IdEntry> { };
+
+class StrTable : public StringTable<StringEntry>
+{
+public:
+   void code_string_table(ostream&, int classtag);
+};
+
+class IntTable : public StringTable<IntEntry>
+{
+protected:
+   // the canonical entry of every value, guarded by alloc_lock
+   std::unordered_map<int, IntEntry *> values;
+   void added(IntEntry *e);
+public:
+   // The canonical entry for the value i, or NULL if there is none yet.
+   IntEntry *lookup_int(int i);
+   // The canonical entry for i, added if need be.  Cheaper than
+   // add_int of StringTable when the value is already there.
+   IntEntry *add_int(int i);
+   void code_string_table(ostream&, int classtag);
+};
+
+extern IdTable idtable;
+extern IntTable inttable;
+extern StrTable stringtable;
+
+//
+// Symbol table snapshots.  save_symbol_tables writes idtable, inttable
+// and stringtable to a file; load_symbol_tables maps such a file into
+// memory and installs its entries in the tables, which must still be
+// empty, with the indices they had when saved.  The strings and their
+// hashes are used in place in the mapping.  Both return false if the
+// file cannot be written or read.
+//
+bool save_symbol_tables(char *filename);
+bool load_symbol_tables(char *filename);
+#endif
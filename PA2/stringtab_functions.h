@@ -0,0 +1,197 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#include "stringtab.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+
+#define MAXSIZE 1000000
+#define min(a,b) (a > b ? b : a)
+
+//
+// A string table is implemented a linked list of Entrys.  Each Entry
+// in the list has a unique string.
+//
+// The list keeps the order the code generator emits constants in, but
+// it is not searched: each shard has an open addressing hash table
+// (linear probing) of its entries, keyed on the hash each Entry
+// stores.  A probe only compares the characters once hash and length
+// agree.  Shards are kept at most half full, so interning a string
+// costs O(1) no matter how many distinct strings there are.
+//
+// A new string is interned holding its shard's lock, which makes the
+// check for an existing entry and the insert one step; the entry itself
+// is then allocated, numbered and chained into the list under
+// alloc_lock.  The locks are always taken in that order.
+//
+
+//
+// The slot holding the entry for s[0..len), or the empty slot where it
+// would go.
+//
+template <class Elem>
+Elem **StringTable<Elem>::Shard::find_slot(char *s, int len, unsigned int h)
+{
+  unsigned int mask = nslots - 1;
+  for (unsigned int i = h & mask; ; i = (i + 1) & mask)
+    if (slots[i] == NULL || slots[i]->equal_string(s,len,h))
+      return &slots[i];
+}
+
+template <class Elem>
+void StringTable<Elem>::Shard::grow()
+{
+  Elem **old = slots;
+  int oldn = nslots;
+
+  nslots = nslots ? 2 * nslots : 64;
+  slots = (Elem **) calloc(nslots, sizeof(Elem *));
+  unsigned int mask = nslots - 1;
+  for (int j = 0; j < oldn; j++) {
+    if (old[j] == NULL)
+      continue;
+    unsigned int i = old[j]->get_hash() & mask;
+    while (slots[i] != NULL)
+      i = (i + 1) & mask;
+    slots[i] = old[j];
+  }
+  free(old);
+}
+
+// the shard a hash belongs to; the low bits pick the slot within it
+#define SHARD_OF(h) ((h) >> 28 & (STRTAB_SHARDS - 1))
+
+//
+// The entry for s[0..len), added if it is not there yet.  `copy' says
+// whether the characters are copied into the arena or used in place.
+//
+template <class Elem>
+Elem *StringTable<Elem>::intern(char *s, int len, unsigned int h, bool copy)
+{
+  Shard& shard = shards[SHARD_OF(h)];
+  std::lock_guard<std::mutex> guard(shard.lock);
+
+  if (2 * (shard.count + 1) > shard.nslots)
+    shard.grow();
+  Elem **slot = shard.find_slot(s,len,h);
+  if (*slot)
+    return *slot;
+
+  //
+  // One arena allocation holds the entry, its list cell and its
+  // characters, in that order.
+  //
+  std::lock_guard<std::mutex> alloc_guard(alloc_lock);
+  size_t size = sizeof(Elem) + sizeof(List<Elem>);
+  char *mem = (char *) arena.alloc(copy ? size + len + 1 : size);
+  char *str = s;
+  if (copy) {
+    str = mem + size;
+    memcpy(str, s, len);
+    str[len] = '\0';
+  }
+
+  Elem *e = new (mem) Elem(str,len,index++,h);
+  tbl = new (mem + sizeof(Elem)) List<Elem>(e, tbl);
+  *slot = e;
+  shard.count++;
+  added(e);
+  return e;
+}
+
+template <class Elem>
+Elem *StringTable<Elem>::add_string(char *s, int maxchars)
+{
+  int len = strnlen(s,maxchars);
+  return intern(s,len,hash_string(s,len),true);
+}
+
+template <class Elem>
+Elem *StringTable<Elem>::add_mapped(char *s, int len, unsigned int h)
+{
+  return intern(s,len,h,false);
+}
+
+template <class Elem>
+Elem *StringTable<Elem>::lookup_string(char *s)
+{
+  int len = strlen(s);
+  unsigned int h = hash_string(s,len);
+  Shard& shard = shards[SHARD_OF(h)];
+  std::lock_guard<std::mutex> guard(shard.lock);
+
+  if (shard.nslots) {
+    Elem **slot = shard.find_slot(s,len,h);
+    if (*slot)
+      return *slot;
+  }
+  assert(0);
+  return NULL;
+}
+
+template <class Elem>
+Elem *StringTable<Elem>::lookup(int ind)
+{
+  for(List<Elem> *l = tbl; l; l = l->tl())
+    if (l->hd()->equal_index(ind))
+      return l->hd();
+  assert(0);
+  return NULL;
+}
+
+template <class Elem>
+Elem *StringTable<Elem>::add_string(char *s)
+{
+ return add_string(s,MAXSIZE);
+}
+
+template <class Elem>
+Elem *StringTable<Elem>::add_int(int i)
+{
+  char buf[20];
+  snprintf(buf, 20, "%d", i);
+  return add_string(buf);
+}
+
+template <class Elem>
+int StringTable<Elem>::first() { return 0; }
+
+template <class Elem>
+int StringTable<Elem>::more(int pos) { return pos < index; }
+
+template <class Elem>
+int StringTable<Elem>::next(int pos) { return pos + 1; }
+
+template <class Elem>
+void StringTable<Elem>::print() { list_print(cerr,tbl); }
+
+//
+// A table in a snapshot is its number of entries followed by the
+// entries in index order, each as its hash, its length and its
+// characters with a '\0', padded to a multiple of 4 bytes.  The list
+// holds the entries newest first, so it is written back to front.
+//
+template <class Elem>
+void StringTable<Elem>::write(FILE *f)
+{
+  Elem **entries = new Elem *[index + 1];
+  int n = 0;
+  for (List<Elem> *l = tbl; l; l = l->tl())
+    entries[n++] = l->hd();
+
+  unsigned int count = n;
+  fwrite(&count, 4, 1, f);
+  while (n-- > 0) {
+    Elem *e = entries[n];
+    unsigned int head[2] = { e->get_hash(), (unsigned int) e->get_len() };
+    static const char zeros[4] = { 0, 0, 0, 0 };
+    fwrite(head, 4, 2, f);
+    fwrite(e->get_string(), 1, e->get_len(), f);
+    fwrite(zeros, 1, 4 - e->get_len() % 4, f);
+  }
+  delete [] entries;
+}
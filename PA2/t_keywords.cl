@@ -0,0 +1,9 @@
+-- Keywords in any case, true/false with a lower and an upper case first
+-- letter, and identifiers that hash like a keyword but are not one.
+class CLASS Class cLaSs inherits INHERITS InHeRiTs
+if IF iF then THEN else ELSE fi FI while WHILE loop LOOP pool POOL
+let LET in IN case CASE esac ESAC of OF new NEW isvoid ISVOID not NOT
+true tRUE True TRUE false fALSE False FALSE
+clams cyass casts esse lemp louse poxl tlen whine ctse eras nqw nxt
+classes clas Class_ if0 i fii in_ inheritsx isvoi letter Loops ofs
+truex tru false_ falsE True1 x y Z
@@ -0,0 +1,397 @@
+-- Runs of every length from 0 to 40 bytes: blanks, comment bodies and
+-- string bodies, so that they end on either side of a 16 or 32 byte step.
+class Runs {
+  a0 : Int <- 0;
+  a1 : Int <-	1;
+  a2 : Int <-
+
+2;
+  a3 : Int <-  	3;
+  a4 : Int <-
+
+4;
+  a5 : Int <-
+   	5;
+  a6 : Int <- 	
+
+6;
+  a7 : Int <-
+
+   	7;
+  a8 : Int <-   	
+
+8;
+  a9 : Int <-	
+
+   	9;
+  a10 : Int <-
+
+   	
+
+10;
+  a11 : Int <-  	
+
+   	11;
+  a12 : Int <-
+
+   	
+
+12;
+  a13 : Int <-
+   	
+
+   	13;
+  a14 : Int <- 	
+
+   	
+
+14;
+  a15 : Int <-
+
+   	
+
+   	15;
+  a16 : Int <-   	
+
+   	
+
+16;
+  a17 : Int <-	
+
+   	
+
+   	17;
+  a18 : Int <-
+
+   	
+
+   	
+
+18;
+  a19 : Int <-  	
+
+   	
+
+   	19;
+  a20 : Int <-
+
+   	
+
+   	
+
+20;
+  a21 : Int <-
+   	
+
+   	
+
+   	21;
+  a22 : Int <- 	
+
+   	
+
+   	
+
+22;
+  a23 : Int <-
+
+   	
+
+   	
+
+   	23;
+  a24 : Int <-   	
+
+   	
+
+   	
+
+24;
+  a25 : Int <-	
+
+   	
+
+   	
+
+   	25;
+  a26 : Int <-
+
+   	
+
+   	
+
+   	
+
+26;
+  a27 : Int <-  	
+
+   	
+
+   	
+
+   	27;
+  a28 : Int <-
+
+   	
+
+   	
+
+   	
+
+28;
+  a29 : Int <-
+   	
+
+   	
+
+   	
+
+   	29;
+  a30 : Int <- 	
+
+   	
+
+   	
+
+   	
+
+30;
+  a31 : Int <-
+
+   	
+
+   	
+
+   	
+
+   	31;
+  a32 : Int <-   	
+
+   	
+
+   	
+
+   	
+
+32;
+  a33 : Int <-	
+
+   	
+
+   	
+
+   	
+
+   	33;
+  a34 : Int <-
+
+   	
+
+   	
+
+   	
+
+   	
+
+34;
+  a35 : Int <-  	
+
+   	
+
+   	
+
+   	
+
+   	35;
+  a36 : Int <-
+
+   	
+
+   	
+
+   	
+
+   	
+
+36;
+  a37 : Int <-
+   	
+
+   	
+
+   	
+
+   	
+
+   	37;
+  a38 : Int <- 	
+
+   	
+
+   	
+
+   	
+
+   	
+
+38;
+  a39 : Int <-
+
+   	
+
+   	
+
+   	
+
+   	
+
+   	39;
+  a40 : Int <-   	
+
+   	
+
+   	
+
+   	
+
+   	
+
+40;
+  (*
+c*) b0 : Int;
+  (*(c*c*) b1 : Int;
+  (*c(c**c*) b2 : Int;
+  (*c
+c***cc*) b3 : Int;
+  (*cc(ccc*) b4 : Int;
+  (*cc(c*ccc*) b5 : Int;
+  (*ccc
+c**ccc*) b6 : Int;
+  (*ccc(c***cccc*) b7 : Int;
+  (*cccc(ccccc*) b8 : Int;
+  (*cccc
+c*ccccc*) b9 : Int;
+  (*ccccc(c**ccccc*) b10 : Int;
+  (*ccccc(c***cccccc*) b11 : Int;
+  (*cccccc
+ccccccc*) b12 : Int;
+  (*cccccc(c*ccccccc*) b13 : Int;
+  (*ccccccc(c**ccccccc*) b14 : Int;
+  (*ccccccc
+c***cccccccc*) b15 : Int;
+  (*cccccccc(ccccccccc*) b16 : Int;
+  (*cccccccc(c*ccccccccc*) b17 : Int;
+  (*ccccccccc
+c**ccccccccc*) b18 : Int;
+  (*ccccccccc(c***cccccccccc*) b19 : Int;
+  (*cccccccccc(ccccccccccc*) b20 : Int;
+  (*cccccccccc
+c*ccccccccccc*) b21 : Int;
+  (*ccccccccccc(c**ccccccccccc*) b22 : Int;
+  (*ccccccccccc(c***cccccccccccc*) b23 : Int;
+  (*cccccccccccc
+ccccccccccccc*) b24 : Int;
+  (*cccccccccccc(c*ccccccccccccc*) b25 : Int;
+  (*ccccccccccccc(c**ccccccccccccc*) b26 : Int;
+  (*ccccccccccccc
+c***cccccccccccccc*) b27 : Int;
+  (*cccccccccccccc(ccccccccccccccc*) b28 : Int;
+  (*cccccccccccccc(c*ccccccccccccccc*) b29 : Int;
+  (*ccccccccccccccc
+c**ccccccccccccccc*) b30 : Int;
+  (*ccccccccccccccc(c***cccccccccccccccc*) b31 : Int;
+  (*cccccccccccccccc(ccccccccccccccccc*) b32 : Int;
+  (*cccccccccccccccc
+c*ccccccccccccccccc*) b33 : Int;
+  (*ccccccccccccccccc(c**ccccccccccccccccc*) b34 : Int;
+  (*ccccccccccccccccc(c***cccccccccccccccccc*) b35 : Int;
+  (*cccccccccccccccccc
+ccccccccccccccccccc*) b36 : Int;
+  (*cccccccccccccccccc(c*ccccccccccccccccccc*) b37 : Int;
+  (*ccccccccccccccccccc(c**ccccccccccccccccccc*) b38 : Int;
+  (*ccccccccccccccccccc
+c***cccccccccccccccccccc*) b39 : Int;
+  (*cccccccccccccccccccc(ccccccccccccccccccccc*) b40 : Int;
+  c0 : Int; --
+  c1 : Int; --d
+  c2 : Int; --dd
+  c3 : Int; --ddd
+  c4 : Int; --dddd
+  c5 : Int; --ddddd
+  c6 : Int; --dddddd
+  c7 : Int; --ddddddd
+  c8 : Int; --dddddddd
+  c9 : Int; --ddddddddd
+  c10 : Int; --dddddddddd
+  c11 : Int; --ddddddddddd
+  c12 : Int; --dddddddddddd
+  c13 : Int; --ddddddddddddd
+  c14 : Int; --dddddddddddddd
+  c15 : Int; --ddddddddddddddd
+  c16 : Int; --dddddddddddddddd
+  c17 : Int; --ddddddddddddddddd
+  c18 : Int; --dddddddddddddddddd
+  c19 : Int; --ddddddddddddddddddd
+  c20 : Int; --dddddddddddddddddddd
+  c21 : Int; --ddddddddddddddddddddd
+  c22 : Int; --dddddddddddddddddddddd
+  c23 : Int; --ddddddddddddddddddddddd
+  c24 : Int; --dddddddddddddddddddddddd
+  c25 : Int; --ddddddddddddddddddddddddd
+  c26 : Int; --dddddddddddddddddddddddddd
+  c27 : Int; --ddddddddddddddddddddddddddd
+  c28 : Int; --dddddddddddddddddddddddddddd
+  c29 : Int; --ddddddddddddddddddddddddddddd
+  c30 : Int; --dddddddddddddddddddddddddddddd
+  c31 : Int; --ddddddddddddddddddddddddddddddd
+  c32 : Int; --dddddddddddddddddddddddddddddddd
+  c33 : Int; --ddddddddddddddddddddddddddddddddd
+  c34 : Int; --dddddddddddddddddddddddddddddddddd
+  c35 : Int; --ddddddddddddddddddddddddddddddddddd
+  c36 : Int; --dddddddddddddddddddddddddddddddddddd
+  c37 : Int; --ddddddddddddddddddddddddddddddddddddd
+  c38 : Int; --dddddddddddddddddddddddddddddddddddddd
+  c39 : Int; --ddddddddddddddddddddddddddddddddddddddd
+  c40 : Int; --dddddddddddddddddddddddddddddddddddddddd
+  s0 : String <- "\nffffffffffffffffffffffffffffffffffffffff\t";
+  s1 : String <- "e\nfffffffffffffffffffffffffffffffffffffff\tg";
+  s2 : String <- "ee\nffffffffffffffffffffffffffffffffffffff\tgg";
+  s3 : String <- "eee\nfffffffffffffffffffffffffffffffffffff\tggg";
+  s4 : String <- "eeee\nffffffffffffffffffffffffffffffffffff\tgggg";
+  s5 : String <- "eeeee\nfffffffffffffffffffffffffffffffffff\tggggg";
+  s6 : String <- "eeeeee\nffffffffffffffffffffffffffffffffff\tgggggg";
+  s7 : String <- "eeeeeee\nfffffffffffffffffffffffffffffffff\tggggggg";
+  s8 : String <- "eeeeeeee\nffffffffffffffffffffffffffffffff\tgggggggg";
+  s9 : String <- "eeeeeeeee\nfffffffffffffffffffffffffffffff\tggggggggg";
+  s10 : String <- "eeeeeeeeee\nffffffffffffffffffffffffffffff\tgggggggggg";
+  s11 : String <- "eeeeeeeeeee\nfffffffffffffffffffffffffffff\tggggggggggg";
+  s12 : String <- "eeeeeeeeeeee\nffffffffffffffffffffffffffff\tgggggggggggg";
+  s13 : String <- "eeeeeeeeeeeee\nfffffffffffffffffffffffffff\tggggggggggggg";
+  s14 : String <- "eeeeeeeeeeeeee\nffffffffffffffffffffffffff\tgggggggggggggg";
+  s15 : String <- "eeeeeeeeeeeeeee\nfffffffffffffffffffffffff\tggggggggggggggg";
+  s16 : String <- "eeeeeeeeeeeeeeee\nffffffffffffffffffffffff\tgggggggggggggggg";
+  s17 : String <- "eeeeeeeeeeeeeeeee\nfffffffffffffffffffffff\t";
+  s18 : String <- "eeeeeeeeeeeeeeeeee\nffffffffffffffffffffff\tg";
+  s19 : String <- "eeeeeeeeeeeeeeeeeee\nfffffffffffffffffffff\tgg";
+  s20 : String <- "eeeeeeeeeeeeeeeeeeee\nffffffffffffffffffff\tggg";
+  s21 : String <- "eeeeeeeeeeeeeeeeeeeee\nfffffffffffffffffff\tgggg";
+  s22 : String <- "eeeeeeeeeeeeeeeeeeeeee\nffffffffffffffffff\tggggg";
+  s23 : String <- "eeeeeeeeeeeeeeeeeeeeeee\nfffffffffffffffff\tgggggg";
+  s24 : String <- "eeeeeeeeeeeeeeeeeeeeeeee\nffffffffffffffff\tggggggg";
+  s25 : String <- "eeeeeeeeeeeeeeeeeeeeeeeee\nfffffffffffffff\tgggggggg";
+  s26 : String <- "eeeeeeeeeeeeeeeeeeeeeeeeee\nffffffffffffff\tggggggggg";
+  s27 : String <- "eeeeeeeeeeeeeeeeeeeeeeeeeee\nfffffffffffff\tgggggggggg";
+  s28 : String <- "eeeeeeeeeeeeeeeeeeeeeeeeeeee\nffffffffffff\tggggggggggg";
+  s29 : String <- "eeeeeeeeeeeeeeeeeeeeeeeeeeeee\nfffffffffff\tgggggggggggg";
+  s30 : String <- "eeeeeeeeeeeeeeeeeeeeeeeeeeeeee\nffffffffff\tggggggggggggg";
+  s31 : String <- "eeeeeeeeeeeeeeeeeeeeeeeeeeeeeee\nfffffffff\tgggggggggggggg";
+  s32 : String <- "eeeeeeeeeeeeeeeeeeeeeeeeeeeeeeee\nffffffff\tggggggggggggggg";
+  s33 : String <- "eeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeee\nfffffff\tgggggggggggggggg";
+  s34 : String <- "eeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeee\nffffff\t";
+  s35 : String <- "eeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeee\nfffff\tg";
+  s36 : String <- "eeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeee\nffff\tgg";
+  s37 : String <- "eeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeee\nfff\tggg";
+  s38 : String <- "eeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeee\nff\tgggg";
+  s39 : String <- "eeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeee\nf\tggggg";
+  s40 : String <- "eeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeee\n\tgggggg";
+};
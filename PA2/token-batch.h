@@ -0,0 +1,39 @@
+#ifndef TOKEN_BATCH_H
+#define TOKEN_BATCH_H
+//////////////////////////////////////////////////////////////////////
+//
+//  token-batch.h
+//
+//  Batched interface to the scanner of cool.flex.  Instead of one
+//  cool_yylex call per token with the value left in cool_yylval,
+//  cool_lex_batch scans up to TOKEN_BATCH_SIZE tokens at a time into
+//  parallel arrays: token[i] is what cool_yylex would have returned,
+//  lineno[i] the value of curr_lineno after it and value[i] the value
+//  of cool_yylval.
+//
+//  The scanner keeps its own line count while filling a batch, so
+//  curr_lineno is left alone and can follow the token being consumed.
+//  Semantic values stay valid after later batches: symbols are interned
+//  and error messages are not pointers into the input buffer.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "cool-parse.h"
+
+#define TOKEN_BATCH_SIZE 256
+
+struct TokenBatch {
+    int count;
+    int token[TOKEN_BATCH_SIZE];
+    int lineno[TOKEN_BATCH_SIZE];
+    YYSTYPE value[TOKEN_BATCH_SIZE];
+};
+
+//
+// Scan the next tokens of the current input file (see cool_lex_file)
+// into `batch' and return batch.count, which is 0 once the end of the
+// file has been reached.
+//
+int cool_lex_batch(TokenBatch& batch);
+
+#endif
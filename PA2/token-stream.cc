@@ -0,0 +1,214 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////
+//
+//  token-stream.cc
+//
+//  Writer and reader for the binary token stream described in
+//  token-stream.h.  The writer is driven by lextest -b, one call per
+//  token that cool_yylex returns; the reader is what the parser's
+//  cool_yylex calls in -b mode.
+//
+//////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include <stdlib.h>
+#include "cool-io.h"
+#include "token-stream.h"
+
+extern int curr_lineno;
+extern char *curr_filename;
+
+enum { ID_TABLE, INT_TABLE, STR_TABLE };
+
+//
+// The symbol table a token's semantic value lives in, or -1 if the
+// token carries no symbol.
+//
+static int token_table(int token)
+{
+  switch (token) {
+  case TYPEID:
+  case OBJECTID:  return ID_TABLE;
+  case INT_CONST: return INT_TABLE;
+  case STR_CONST: return STR_TABLE;
+  default:        return -1;
+  }
+}
+
+///////////////////////////////////////////////////////////////////
+//
+// TokenWriter
+//
+///////////////////////////////////////////////////////////////////
+
+TokenWriter::TokenWriter(FILE *out) : m_out(out)
+{
+  unsigned int v = TOKEN_STREAM_VERSION;
+  fwrite(TOKEN_STREAM_MAGIC, 1, 4, m_out);
+  for (int i = 0; i < 4; i++)
+    putc((v >> (8 * i)) & 0xff, m_out);
+}
+
+void TokenWriter::put_varint(unsigned int v)
+{
+  while (v >= 0x80) {
+    putc((v & 0x7f) | 0x80, m_out);
+    v >>= 7;
+  }
+  putc(v, m_out);
+}
+
+void TokenWriter::put_string(const char *s, int len)
+{
+  put_varint(len);
+  fwrite(s, 1, len, m_out);
+}
+
+void TokenWriter::put_symbol(int table, Symbol sym)
+{
+  std::unordered_map<Symbol, int>::iterator it = m_index[table].find(sym);
+  if (it != m_index[table].end()) {
+    put_varint(it->second);
+    return;
+  }
+  int index = m_index[table].size();
+  m_index[table][sym] = index;
+  put_varint(index);
+  put_string(sym->get_string(), sym->get_len());
+}
+
+void TokenWriter::file(const char *filename)
+{
+  put_varint(0);
+  put_string(filename, strlen(filename));
+}
+
+void TokenWriter::token(int lineno, int token, YYSTYPE yylval)
+{
+  put_varint(token);
+  put_varint(lineno);
+
+  int table = token_table(token);
+  if (table >= 0)
+    put_symbol(table, yylval.symbol);
+  else if (token == BOOL_CONST)
+    putc(yylval.boolean ? 1 : 0, m_out);
+  else if (token == ERROR)
+    put_string(yylval.error_msg, strlen(yylval.error_msg));
+}
+
+///////////////////////////////////////////////////////////////////
+//
+// TokenReader
+//
+///////////////////////////////////////////////////////////////////
+
+TokenReader::TokenReader(FILE *in) : m_in(in), m_started(false)
+{
+}
+
+void TokenReader::corrupt()
+{
+  cerr << "Malformed binary token stream" << endl;
+  exit(1);
+}
+
+//
+// A clean end of input is only allowed where a record would start;
+// get_varint then returns 0, which next() passes on as end of stream.
+//
+unsigned int TokenReader::get_varint(bool at_record_start)
+{
+  unsigned int v = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    int c = getc(m_in);
+    if (c == EOF) {
+      if (at_record_start && shift == 0)
+        return 0;
+      corrupt();
+    }
+    v |= (unsigned int) (c & 0x7f) << shift;
+    if (!(c & 0x80))
+      return v;
+  }
+  corrupt();
+  return 0;
+}
+
+//
+// The string is left NUL terminated in m_buf, which is reused by the
+// next call.
+//
+char *TokenReader::get_string()
+{
+  unsigned int len = get_varint(false);
+  m_buf.resize(len + 1);
+  if (fread(&m_buf[0], 1, len, m_in) != len)
+    corrupt();
+  m_buf[len] = '\0';
+  return &m_buf[0];
+}
+
+Symbol TokenReader::get_symbol(int table)
+{
+  std::vector<Symbol>& syms = m_symbols[table];
+  unsigned int index = get_varint(false);
+  if (index < syms.size())
+    return syms[index];
+  if (index != syms.size())
+    corrupt();
+
+  char *s = get_string();
+  int len = m_buf.size() - 1;
+  Symbol sym;
+  switch (table) {
+  case ID_TABLE:  sym = idtable.add_string(s, len); break;
+  case INT_TABLE: sym = inttable.add_string(s, len); break;
+  default:        sym = stringtable.add_string(s, len); break;
+  }
+  syms.push_back(sym);
+  return sym;
+}
+
+int TokenReader::next(YYSTYPE& yylval)
+{
+  if (!m_started) {
+    unsigned char header[8];
+    if (fread(header, 1, 8, m_in) != 8 ||
+        memcmp(header, TOKEN_STREAM_MAGIC, 4) != 0)
+      corrupt();
+    unsigned int version = 0;
+    for (int i = 0; i < 4; i++)
+      version |= (unsigned int) header[4 + i] << (8 * i);
+    if (version != TOKEN_STREAM_VERSION)
+      corrupt();
+    m_started = true;
+  }
+
+  int token;
+  while ((token = get_varint(true)) == 0) {
+    if (feof(m_in))
+      return 0;
+    curr_filename = strdup(get_string());
+  }
+
+  curr_lineno = get_varint(false);
+
+  int table = token_table(token);
+  if (table >= 0) {
+    yylval.symbol = get_symbol(table);
+  } else if (token == BOOL_CONST) {
+    int c = getc(m_in);
+    if (c == EOF)
+      corrupt();
+    yylval.boolean = c;
+  } else if (token == ERROR) {
+    yylval.error_msg = strdup(get_string());
+  }
+  return token;
+}
@@ -0,0 +1,89 @@
+#ifndef TOKEN_STREAM_H
+#define TOKEN_STREAM_H
+//////////////////////////////////////////////////////////////////////
+//
+//  token-stream.h
+//
+//  A binary token stream for handing tokens from the lexer to the
+//  parser, in place of the dump_cool_token text that the parser would
+//  otherwise have to lex a second time.
+//
+//  The stream starts with the magic "CTOK" and a little endian u32
+//  version, followed by one record per token:
+//
+//     varint token       the cool_yylex return value
+//     varint line        curr_lineno after the token was scanned
+//     payload            depends on the token:
+//        TYPEID, OBJECTID   symbol index into the id table
+//        INT_CONST          symbol index into the int table
+//        STR_CONST          symbol index into the string table
+//        BOOL_CONST         one byte, 0 or 1
+//        ERROR              the error message as a string
+//
+//  Symbol indices are numbered per table in the order the symbols
+//  first appear, so a symbol is defined inline the first time it is
+//  used: an index equal to the number of symbols seen so far in that
+//  table is followed by the symbol's characters as a string.  Later
+//  uses are just the index.  A string is a varint length followed by
+//  that many characters.
+//
+//  Token 0 never comes out of the scanner, so it is used for the
+//  "#name" record that starts every input file; its payload is the
+//  file name as a string and it has no line field.
+//
+//  The stream can be written and consumed incrementally, which keeps
+//  ./lexer -b | ./parser -b a pipeline.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "cool-parse.h"
+#include "stringtab.h"
+
+#define TOKEN_STREAM_MAGIC   "CTOK"
+#define TOKEN_STREAM_VERSION 1
+
+class TokenWriter {
+private:
+    FILE *m_out;
+    std::unordered_map<Symbol, int> m_index[3];
+
+    void put_varint(unsigned int v);
+    void put_string(const char *s, int len);
+    void put_symbol(int table, Symbol sym);
+
+public:
+    TokenWriter(FILE *out);
+
+    void file(const char *filename);
+    void token(int lineno, int token, YYSTYPE yylval);
+};
+
+class TokenReader {
+private:
+    FILE *m_in;
+    std::vector<Symbol> m_symbols[3];
+    std::string m_buf;
+    bool m_started;
+
+    unsigned int get_varint(bool at_record_start);
+    char *get_string();
+    Symbol get_symbol(int table);
+    void corrupt();
+
+public:
+    TokenReader(FILE *in);
+
+    //
+    // next() has the contract of cool_yylex: it returns the next token,
+    // or 0 at the end of the stream, leaving its semantic value in
+    // yylval and its line in curr_lineno.  "#name" records update
+    // curr_filename and are not returned.
+    //
+    int next(YYSTYPE& yylval);
+};
+
+#endif
@@ -0,0 +1 @@
+../PA5/ast-binary.cc
\ No newline at end of file
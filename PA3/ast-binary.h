@@ -0,0 +1 @@
+../PA5/ast-binary.h
\ No newline at end of file
@@ -0,0 +1,18 @@
+(*
+ *  backslash.cl
+ *
+ *  Strings with escapes that the PA2 lexer's default rule echoes.  The
+ *  echo must not end up in the binary token stream:
+ *
+ *     % ../PA2/lexer -b backslash.cl | ./parser -b
+ *)
+
+class Main inherits IO {
+    s : String <- "backslash: \\ done";
+    t : String <- "two \\\\ in a row";
+    u : String <- "other escapes: \x \q \z";
+
+    main() : Object {
+        out_string(s.concat(t).concat(u))
+    };
+};
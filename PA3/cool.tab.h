@@ -79,7 +79,9 @@ extern int cool_yydebug;
     ASSIGN = 280,                  /* ASSIGN  */
     NOT = 281,                     /* NOT  */
     LE = 282,                      /* LE  */
-    ERROR = 283                    /* ERROR  */
+    ERROR = 283,                   /* ERROR  */
+    LAZY_EXPR = 285,               /* LAZY_EXPR  */
+    EXPR_START = 286               /* EXPR_START  */
   };
   typedef enum yytokentype yytoken_kind_t;
 #endif
@@ -114,12 +116,14 @@ extern int cool_yydebug;
 #define NOT 281
 #define LE 282
 #define ERROR 283
+#define LAZY_EXPR 285
+#define EXPR_START 286
 
 /* Value type.  */
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
 union YYSTYPE
 {
-#line 89 "cool.y"
+#line 126 "cool.y"
 
       Boolean boolean;
       Symbol symbol;
@@ -137,7 +141,7 @@ union YYSTYPE
       char *error_msg;
     
 
-#line 141 "cool.tab.h"
+#line 145 "cool.tab.h"
 
 };
 typedef union YYSTYPE YYSTYPE;
@@ -77,12 +77,49 @@
     void yyerror(char *s);        /*  defined below; called for each parse error */
     extern int yylex();           /*  the entry point to the lexer  */
     
+    /* Growing the parser's stacks.  In C++ bison only moves its stacks
+    itself when YYLTYPE is a struct, so with int locations a program
+    nested more than 200 deep would run out of stack.  yyoverflow
+    doubles them instead, up to YYMAXDEPTH entries; the arrays of the
+    previous growth (or the previous parse) are freed on the next one. */
+    #define YYMAXDEPTH 10000000
+    #define yyoverflow(msg, ss, ssize, vs, vsize, ls, lsize, stacksize) \
+    grow_parse_stacks(msg, ss, ssize, vs, vsize, ls, lsize, stacksize)
+    
+    static void *parse_stacks[3];
+    
+    template <class T, class N>
+    static void grow_parse_stack(T **stack, N bytes, N size, int which)
+    {
+      T *s = (T *) malloc(size * sizeof(T));
+      memcpy(s, *stack, bytes);
+      free(parse_stacks[which]);
+      parse_stacks[which] = *stack = s;
+    }
+    
+    template <class S, class V, class L, class N, class Size>
+    static void grow_parse_stacks(const char *msg, S **ss, N ssize, V **vs, N vsize,
+    L **ls, N lsize, Size *stacksize)
+    {
+      if (*stacksize >= YYMAXDEPTH) {
+        yyerror((char *) msg);
+        return;                   /* the parser gives up */
+      }
+      Size size = 2 * *stacksize < YYMAXDEPTH ? 2 * *stacksize : YYMAXDEPTH;
+      grow_parse_stack(ss, ssize, (N) size, 0);
+      grow_parse_stack(vs, vsize, (N) size, 1);
+      grow_parse_stack(ls, lsize, (N) size, 2);
+      *stacksize = size;
+    }
+    
     /************************************************************************/
     /*                DONT CHANGE ANYTHING IN THIS SECTION                  */
     
     Program ast_root;	      /* the result of the parse  */
     Classes parse_results;        /* for use in semantic analysis */
     int omerrs = 0;               /* number of errors in lexing and parsing */
+    
+    Expression body_result;       /* a lazily parsed body, see lazy-body.h */
     %}
     
     /* A union of all the types that can be the result of parsing actions. */
@@ -124,6 +161,12 @@
     
     /*  DON'T CHANGE ANYTHING ABOVE THIS LINE, OR YOUR PARSER WONT WORK       */
     /**************************************************************************/
+
+    /* coolc -L (see lazy-body.h): a method body or attribute initializer
+    the scanner skipped, with a placeholder as its value, and the token
+    that starts the parse of such a body on its own. */
+    %token <expression> LAZY_EXPR
+    %token EXPR_START
     
     /* Complete the nonterminal list below, giving a type for the semantic
     value of each non terminal. (See section 3.6 in the bison 
@@ -161,6 +204,7 @@
     Save the root of the abstract syntax tree in a global variable.
     */
     program	: class_list	{ @$ = @1;SET_NODELOC(@1);ast_root = program($1); }
+    | EXPR_START expr	{ @$ = @2;$$ = NULL;body_result = $2; }
     ;
     
     class_list
@@ -242,8 +286,8 @@ expr_list
 block_list
   : expr ';'
       { $$ = single_Expressions($1); }
-  | expr ';' block_list
-      { $$ = append_Expressions(single_Expressions($1), $3); }
+  | block_list expr ';'
+      { $$ = append_Expressions($1, single_Expressions($2)); }
   ;
 
 /* case branches */
@@ -365,6 +409,10 @@ expr
 
   | OBJECTID
     { SET_NODELOC(@1); $$ = object($1); }
+
+  /* a body the scanner skipped (coolc -L); the placeholder is already made */
+  | LAZY_EXPR
+    { $$ = $1; }
   ;
 
     
@@ -30,6 +30,8 @@ extern int cool_yydebug;        // for the parser
        bool disable_reg_alloc;  // Don't do register allocation
 
        int cgen_optimize;       // optimize switch for code generator 
+       int token_binary;        // exchange tokens between phases in binary
+       int ast_binary;          // write the AST in binary for the next phase
        char *out_filename;      // file name for generated code
        Memmgr cgen_Memmgr = GC_NOGC;      // enable/disable garbage collection
        Memmgr_Test cgen_Memmgr_Test = GC_NORMAL;  // normal/test GC
@@ -51,9 +53,11 @@ void handle_flags(int argc, char *argv[]) {
   cgen_debug = 0;
   cgen_optimize = 0;
   disable_reg_alloc = 0;
+  token_binary = 0;
+  ast_binary = 0;
   
 
-  while ((c = getopt(argc, argv, "lpscvrOo:gtT")) != -1) {
+  while ((c = getopt(argc, argv, "lpscvrOo:gtTbB")) != -1) {
     switch (c) {
 #ifdef DEBUG
     case 'l':
@@ -99,6 +103,12 @@ void handle_flags(int argc, char *argv[]) {
     case 'O':  // enable optimization
       cgen_optimize = 1;
       break;
+    case 'b':  // read/write tokens in the binary format of token-stream.h
+      token_binary = 1;
+      break;
+    case 'B':  // write the AST in the binary format of ast-binary.h
+      ast_binary = 1;
+      break;
     case '?':
       unknownopt = 1;
       break;
@@ -111,9 +121,9 @@ void handle_flags(int argc, char *argv[]) {
   if (unknownopt) {
       cerr << "usage: " << argv[0] << 
 #ifdef DEBUG
-	  " [-lvpscOgtTr -o outname] [input-files]\n";
+	  " [-lvpscOgtTrbB -o outname] [input-files]\n";
 #else
-      " [-OgtT -o outname] [input-files]\n";
+      " [-OgtTbB -o outname] [input-files]\n";
 #endif
       exit(1);
   }
@@ -10,6 +10,11 @@
 //
 //  Reads a COOL token stream from a file and builds the abstract syntax tree.
 //
+//  With -b the tokens are read in the binary format of token-stream.h
+//  (as written by lexer -b) instead of as dump_cool_token text.
+//  With -B the AST is written in the binary format of ast-binary.h
+//  (as read by semant -b) instead of as dump_with_types text.
+//
 //////////////////////////////////////////////////////////////////////////////
 
 #include <stdio.h>     // for Linux system
@@ -18,6 +23,8 @@
 #include "cool-tree.h"
 #include "utilities.h"  // for fatal_error
 #include "cool-parse.h"
+#include "token-stream.h"
+#include "ast-binary.h"
 
 //
 // These globals keep everything working.
@@ -29,18 +36,46 @@ extern Program ast_root;	 // the AST produced by the parse
 char *curr_filename = "<stdin>";
 
 extern int omerrs;             // a count of lex and parse errors
+extern int token_binary;       // read a binary token stream (-b)
+extern int ast_binary;         // write a binary AST (-B)
 
 extern int cool_yyparse();
+extern int cool_text_yylex();  // see tokens-text.cc
+extern YYSTYPE cool_yylval;
 void handle_flags(int argc, char *argv[]);
 
-int main(int argc, char *argv[]) {
+//
+// The parser's source of tokens.  The binary reader hands over symbols
+// already interned, so the token text is never scanned a second time.
+//
+int cool_yylex() {
+    static TokenReader *reader = NULL;
+
+    if (!token_binary)
+	return cool_text_yylex();
+    if (reader == NULL)
+	reader = new TokenReader(token_file);
+    return reader->next(cool_yylval);
+}
+
+static int phase_main(int argc, char *argv[]) {
     handle_flags(argc, argv);
     cool_yyparse();
     if (omerrs != 0) {
 	cerr << "Compilation halted due to lex and parse errors\n";
 	exit(1);
     }
-    ast_root->dump_with_types(cout,0);
+    if (ast_binary)
+	dump_binary(cout, ast_root);
+    else
+	ast_root->dump_with_types(cout,0);
     return 0;
 }
 
+//
+// Everything runs on a stack deep enough for deeply nested programs;
+// see run_on_ast_stack in tree.h.
+//
+int main(int argc, char *argv[]) {
+    return run_on_ast_stack(phase_main, argc, argv);
+}
@@ -0,0 +1 @@
+../PA2/token-stream.cc
\ No newline at end of file
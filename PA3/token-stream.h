@@ -0,0 +1 @@
+../PA2/token-stream.h
\ No newline at end of file
@@ -0,0 +1,19 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//  tokens-text.cc
+//
+//  The flex scanner for the text token format of dump_cool_token,
+//  compiled under the name cool_text_yylex so that parser-phase.cc can
+//  choose between it and the binary token stream in cool_yylex.
+//  tokens-lex.cc is generated, so it is renamed here rather than edited.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#define cool_yylex cool_text_yylex
+#include "tokens-lex.cc"
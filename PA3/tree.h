@@ -0,0 +1,365 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#ifndef TREE_H
+#define TREE_H
+///////////////////////////////////////////////////////////////////////////
+//
+// file: tree.h
+//
+// This file defines the basic class of tree node and list
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include "stringtab.h"
+#include "cool-io.h"
+#include <stdlib.h>
+
+/////////////////////////////////////////////////////////////////////
+//
+// tree_node
+//
+// All APS nodes are derived from tree_node.  There is a
+// protected field:
+//    int line_number     line in the source file from which this node came;
+//                        this is typically set by the parser
+//
+// The following operation is defined on all tree nodes:
+//
+//    tree_node *set(tree_node *)   sets the line number of this node to
+//                                  be the same as the line number of its
+//                                  argument
+//
+// Tree nodes, list cells included, are allocated from the node arena
+// in tree.cc rather than one by one from the heap: `new' on any
+// subclass bumps a pointer in the current block, and delete does
+// nothing.  release_ast_nodes frees all nodes at once.
+//
+/////////////////////////////////////////////////////////////////////
+
+class tree_node {
+protected:
+    int line_number;            // stash the line number when node is made
+public:
+    tree_node();
+    virtual tree_node *copy() = 0;
+    virtual ~tree_node() { }
+    virtual void dump(ostream& stream, int n) = 0;
+    int get_line_number();
+    tree_node *set(tree_node *);
+
+    static void *operator new(size_t size);
+    static void operator delete(void *) { }
+};
+
+//
+// Free every tree node allocated so far.  Destructors are not run, and
+// no node of the old trees may be used afterwards.
+//
+void release_ast_nodes();
+
+//
+// The passes over the AST (the parsers' actions, semant's tc, cgen's
+// code, dump_with_types, ...) recurse once per level of the tree, so
+// a deeply nested program needs a deep C++ stack.  run_on_ast_stack
+// calls fn(argc, argv) on a thread whose stack is AST_STACK_SIZE bytes
+// of reserved address space, and returns what fn returns.  Only the
+// pages the recursion actually reaches are ever backed by memory, so
+// memory grows with the nesting depth of the program being compiled.
+// The phase drivers run their whole main this way.
+//
+#define AST_STACK_SIZE (sizeof(void *) == 8 ? (size_t) 8 << 30 : (size_t) 512 << 20)
+
+int run_on_ast_stack(int (*fn)(int, char **), int argc, char **argv);
+
+//
+// run_on_ast_threads calls fn(arg) on n threads at once, each on a stack
+// like run_on_ast_stack's, and returns when all of them have returned.
+// If some of the threads cannot be started, fn(arg) is also called on
+// the current thread, so fn should be a worker that takes its work from
+// a shared queue rather than a fixed share of it.
+//
+void run_on_ast_threads(int n, void (*fn)(void *), void *arg);
+
+//
+// Hash-consing.  With hash_cons_ast set (coolc -H) the constructors in
+// cool-tree.cc look a node up by its kind and fields before making it
+// and return the node already made, if there is one, so structurally
+// identical subtrees are built once and shared.  Only subtrees without
+// side effects whose type does not depend on where they appear are
+// shared (see cool-tree.cc); a shared node keeps the line number of its
+// first occurrence.
+//
+// A shared node is the identity of its subtree: two shared nodes are
+// the same pointer exactly when their subtrees are equal.  shared_id
+// numbers shared nodes 1, 2, ... in the order they were made and is 0
+// for every other node, so a pass can memoize a result per unique
+// subtree in an array of shared_count() + 1 entries.
+//
+// find_shared and add_shared are the table behind the constructors;
+// tag is the kind of node and a, b its fields (children, symbols).
+// release_ast_nodes empties the table.
+//
+extern int hash_cons_ast;
+
+tree_node *find_shared(int tag, const void *a, const void *b);
+void add_shared(int tag, const void *a, const void *b, tree_node *t);
+int shared_id(tree_node *t);
+int shared_count();
+
+///////////////////////////////////////////////////////////////////
+//
+//  Lists of APS objects are implemented by the "list_node"
+//  template.
+//
+//  Class list_node has three subclasses
+//   nil_node         : the empty list
+//   single_list_node : the list with 1 element
+//   append_node      : concatenation of two lists
+//
+//  An iterator is provided for list_node: first(), more(i), next(i)
+//  and nth(i), where i is an integer position in the list.
+//
+//  Whatever way a list was built, its elements are kept flat in one
+//  array (list_items), so nth, len and more take constant time and a
+//  loop over a list walks consecutive memory.  Lists never change once
+//  made, which lets several lists share an array: a list is the first
+//  `length' elements of its items.  Appending to a list that ends
+//  where its items end extends the array in place, so building a list
+//  left to right one element at a time, as the parser does, costs
+//  amortized O(1) per element; any other append copies both lists.
+//
+///////////////////////////////////////////////////////////////////
+
+template <class Elem>
+struct list_items {
+    Elem *elems;
+    int count;                   // elements used by the longest list
+    int size;                    // room in elems
+};
+
+template <class Elem>
+class list_node : public tree_node {
+protected:
+    list_items<Elem> *items;     // NULL for the empty list
+    int length;
+
+    list_node() : items(NULL), length(0) { }
+    void concat(list_node<Elem> *l1, list_node<Elem> *l2);
+public:
+    tree_node *copy()            { return copy_list(); }
+    Elem nth(int n);
+            //
+            // The iterator for list_node
+            //
+    int first()                  { return 0; }
+    int next(int n)              { return n + 1; }
+    int more(int n)              { return (n < length); }
+
+    list_node<Elem> *copy_list();
+    virtual ~list_node() { }
+    int len()                    { return length; }
+    Elem nth_length(int n, int &len);
+    void dump(ostream& stream, int n);
+
+    static list_node<Elem> *nil();
+    static list_node<Elem> *single(Elem);
+    static list_node<Elem> *append(list_node<Elem> *l1,list_node<Elem> *l2);
+};
+
+char *pad(int n);                // add n blanks to the output stream
+extern int info_size;            // how much extra information to print
+
+template <class Elem>
+class nil_node : public list_node<Elem> {
+public:
+    nil_node() { }
+};
+
+template <class Elem>
+class single_list_node : public list_node<Elem> {
+    Elem elem;
+    list_items<Elem> one;        // items of the list: just elem
+public:
+    single_list_node(Elem t) {
+	elem = t;
+	one.elems = &elem;
+	one.count = one.size = 1;
+	this->items = &one;
+	this->length = 1;
+    }
+};
+
+template <class Elem>
+class append_node : public list_node<Elem> {
+public:
+    append_node(list_node<Elem> *l1, list_node<Elem> *l2) {
+	this->concat(l1, l2);
+    }
+};
+
+template <class Elem> single_list_node<Elem> *list(Elem x);
+template <class Elem> append_node<Elem> *cons(Elem x, list_node<Elem> *l);
+template <class Elem> append_node<Elem> *xcons(list_node<Elem> *l, Elem x);
+
+///////////////////////////////////////////////////////////////////////////
+//
+// list_node::nil
+//
+// Create an empty list.
+//
+///////////////////////////////////////////////////////////////////////////
+template <class Elem> list_node<Elem> *list_node<Elem>::nil()
+{
+    return new nil_node<Elem>();
+}
+
+///////////////////////////////////////////////////////////////////////////
+//
+// list_node::single
+//
+// Create a list with one element.
+//
+///////////////////////////////////////////////////////////////////////////
+template <class Elem> list_node<Elem> *list_node<Elem>::single(Elem e)
+{
+    return new single_list_node<Elem>(e);
+}
+
+///////////////////////////////////////////////////////////////////////////
+//
+// list_node::append
+//
+// Concatenate two lists.
+//
+///////////////////////////////////////////////////////////////////////////
+template <class Elem> list_node<Elem> *list_node<Elem>::append(list_node<Elem> *l1,list_node<Elem> *l2)
+{
+    return new append_node<Elem>(l1,l2);
+}
+
+///////////////////////////////////////////////////////////////////////////
+//
+// list_node::concat
+//
+// Make this list the elements of l1 followed by those of l2.  If l1
+// is the longest list on its items and there is room, or the array can
+// be doubled, l2 is added to l1's items; otherwise both are copied to
+// new items.  The arrays come from the node arena, so an array that is
+// outgrown is simply left behind.
+//
+///////////////////////////////////////////////////////////////////////////
+template <class Elem> void list_node<Elem>::concat(list_node<Elem> *l1, list_node<Elem> *l2)
+{
+    int total = l1->length + l2->length;
+    list_items<Elem> *it = l1->items;
+
+    if (it == NULL || it->count != l1->length) {
+	it = (list_items<Elem> *) tree_node::operator new(sizeof(list_items<Elem>));
+	it->size = total < 4 ? 4 : total;
+	it->elems = (Elem *) tree_node::operator new(it->size * sizeof(Elem));
+	for (int i = 0; i < l1->length; i++)
+	    it->elems[i] = l1->items->elems[i];
+	it->count = l1->length;
+    }
+    if (total > it->size) {
+	int size = 2 * it->size > total ? 2 * it->size : total;
+	Elem *elems = (Elem *) tree_node::operator new(size * sizeof(Elem));
+	for (int i = 0; i < it->count; i++)
+	    elems[i] = it->elems[i];
+	it->elems = elems;
+	it->size = size;
+    }
+    // l2 may share the items (even be l1), so index through it each time
+    for (int i = 0; i < l2->length; i++)
+	it->elems[l1->length + i] = l2->items->elems[i];
+    it->count = total;
+
+    items = it;
+    length = total;
+}
+
+///////////////////////////////////////////////////////////////////////////
+//
+// list_node::nth
+//
+// Return the nth element of the list; exit with an error if the list
+// is shorter.
+//
+///////////////////////////////////////////////////////////////////////////
+template <class Elem> Elem list_node<Elem>::nth(int n)
+{
+    if (n >= 0 && n < length)
+	return items->elems[n];
+    else {
+	cerr << "error: outside the range of the list\n";
+	exit(1);
+    }
+    return 0;
+}
+
+template <class Elem> Elem list_node<Elem>::nth_length(int n, int &len)
+{
+    len = length;
+    if (n >= 0 && n < length)
+	return items->elems[n];
+    else
+	return NULL;
+}
+
+template <class Elem> list_node<Elem> *list_node<Elem>::copy_list()
+{
+    list_node<Elem> *l = new nil_node<Elem>();
+    for (int i = 0; i < length; i++)
+	l = new append_node<Elem>(l, new single_list_node<Elem>((Elem) items->elems[i]->copy()));
+    return l;
+}
+
+template <class Elem> void list_node<Elem>::dump(ostream& stream, int n)
+{
+    if (length == 0)
+	stream << pad(n) << "(nil)\n";
+    for (int i = 0; i < length; i++)
+	items->elems[i]->dump(stream, n);
+}
+
+///////////////////////////////////////////////////////////////////////////
+//
+// list
+//
+// Create a list with one element.
+//
+///////////////////////////////////////////////////////////////////////////
+template <class Elem> single_list_node<Elem> *list(Elem x)
+{
+    return new single_list_node<Elem>(x);
+}
+
+///////////////////////////////////////////////////////////////////////////
+//
+// cons
+//
+// Add an element to the front of a list.
+//
+///////////////////////////////////////////////////////////////////////////
+template <class Elem> append_node<Elem> *cons(Elem x, list_node<Elem> *l)
+{
+    return new append_node<Elem>(list(x),l);
+}
+
+///////////////////////////////////////////////////////////////////////////
+//
+// xcons
+//
+// Add an element to the end of a list.
+//
+///////////////////////////////////////////////////////////////////////////
+template <class Elem> append_node<Elem> *xcons(list_node<Elem> *l, Elem x)
+{
+    return new append_node<Elem>(l,list(x));
+}
+
+#endif
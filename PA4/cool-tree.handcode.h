@@ -13,6 +13,45 @@
 #define yylineno curr_lineno;
 extern int yylineno;
 
+class AstWriter;
+
+//
+// The kinds of node, as tags of the binary AST of ast-binary.h (the
+// same as PA5's).
+//
+enum AstTag {
+    AST_PROGRAM = 1,
+    AST_CLASS,
+    AST_METHOD,
+    AST_ATTR,
+    AST_FORMAL,
+    AST_BRANCH,
+    AST_ASSIGN,
+    AST_STATIC_DISPATCH,
+    AST_DISPATCH,
+    AST_COND,
+    AST_LOOP,
+    AST_TYPCASE,
+    AST_BLOCK,
+    AST_LET,
+    AST_PLUS,
+    AST_SUB,
+    AST_MUL,
+    AST_DIVIDE,
+    AST_NEG,
+    AST_LT,
+    AST_EQ,
+    AST_LEQ,
+    AST_COMP,
+    AST_INT_CONST,
+    AST_BOOL_CONST,
+    AST_STRING_CONST,
+    AST_NEW,
+    AST_ISVOID,
+    AST_NO_EXPR,
+    AST_OBJECT
+};
+
 inline Boolean copy_Boolean(Boolean b) {return b; }
 inline void assert_Boolean(Boolean) {}
 inline void dump_Boolean(ostream& stream, int padding, Boolean b)
@@ -48,35 +87,41 @@ typedef Cases_class *Cases;
 
 #define Program_EXTRAS                          \
 virtual void semant() = 0;			\
-virtual void dump_with_types(ostream&, int) = 0; 
+virtual void dump_with_types(ostream&, int) = 0; \
+virtual void dump_binary(AstWriter&) = 0;
 
 
 
 #define program_EXTRAS                          \
 void semant();     				\
-void dump_with_types(ostream&, int);            
+void dump_with_types(ostream&, int);            \
+void dump_binary(AstWriter&);
 
 #define Class__EXTRAS                                   \
 virtual Symbol get_filename() = 0;                      \
 virtual Symbol get_name() = 0;                          \
 virtual Symbol get_parent() = 0;                        \
 virtual Features get_features() = 0;                    \
-virtual void dump_with_types(ostream&,int) = 0;
+virtual void dump_with_types(ostream&,int) = 0;         \
+virtual void dump_binary(AstWriter&) = 0;
 
 #define class__EXTRAS                                   \
 Symbol get_filename() { return filename; }              \
 Symbol get_name() { return name; }                      \
 Symbol get_parent() { return parent; }                  \
 Features get_features() { return features; }            \
-void dump_with_types(ostream&,int);                
+void dump_with_types(ostream&,int);                     \
+void dump_binary(AstWriter&);
 
 
 #define Feature_EXTRAS                                        \
-virtual void dump_with_types(ostream&,int) = 0; 
+virtual void dump_with_types(ostream&,int) = 0;               \
+virtual void dump_binary(AstWriter&) = 0;
 
 
 #define Feature_SHARED_EXTRAS                                       \
-void dump_with_types(ostream&,int);    
+void dump_with_types(ostream&,int);                                 \
+void dump_binary(AstWriter&);
 
 #define method_EXTRAS                                         \
 Symbol get_name() { return name; }                             \
@@ -92,26 +137,30 @@ Expression get_init() { return init; }
 #define formal_EXTRAS                                         \
 Symbol get_name() { return name; }                             \
 Symbol get_type_decl() { return type_decl; }                   \
-void dump_with_types(ostream&,int);
+void dump_with_types(ostream&,int);                            \
+void dump_binary(AstWriter&);
 
 
 
 
 #define Formal_EXTRAS                              \
-virtual void dump_with_types(ostream&,int) = 0;
+virtual void dump_with_types(ostream&,int) = 0;    \
+virtual void dump_binary(AstWriter&) = 0;
 
 
 
 
 #define Case_EXTRAS                             \
-virtual void dump_with_types(ostream& ,int) = 0;
+virtual void dump_with_types(ostream& ,int) = 0; \
+virtual void dump_binary(AstWriter&) = 0;
 
 
 #define branch_EXTRAS                                   \
 Symbol get_name() { return name; }                      \
 Symbol get_type_decl() { return type_decl; }            \
 Expression get_expr() { return expr; }                  \
-void dump_with_types(ostream& ,int);
+void dump_with_types(ostream& ,int);                    \
+void dump_binary(AstWriter&);
 
 
 
@@ -122,13 +171,15 @@ Expression set_type(Symbol s) { type = s; return this; } \
 virtual Symbol tc(class ClassTable* ct, Symbol current_class,          \
                 SymbolTable<Symbol, Symbol>* obj_env) = 0;           \
 virtual void dump_with_types(ostream&,int) = 0;  \
+virtual void dump_binary(AstWriter&) = 0;    \
 void dump_type(ostream&, int);               \
 Expression_class() { type = (Symbol) NULL; }
 
 #define Expression_SHARED_EXTRAS \
 Symbol tc(class ClassTable* ct, Symbol current_class, \
           SymbolTable<Symbol, Symbol>* obj_env); \
-void dump_with_types(ostream&,int);
+void dump_with_types(ostream&,int);              \
+void dump_binary(AstWriter&);
 
 
 #endif
@@ -26,11 +26,15 @@ extern int yy_flex_debug;       // for the lexer; prints recognized rules
 extern int cool_yydebug;        // for the parser
        int lex_verbose;         // also for the lexer; prints tokens
        int semant_debug;        // for semantic analysis
+       int semant_jobs;         // -j: threads for type checking
        int cgen_debug;          // for code gen
        bool disable_reg_alloc;  // Don't do register allocation
 
        int cgen_optimize;       // optimize switch for code generator 
        char *out_filename;      // file name for generated code
+       char *symbol_file;       // -y: symbol table snapshot to start from
+       char *basic_symbols_file; // -Y: write the predefined symbols here
+       int ast_binary;          // exchange the AST between phases in binary
        Memmgr cgen_Memmgr = GC_NOGC;      // enable/disable garbage collection
        Memmgr_Test cgen_Memmgr_Test = GC_NORMAL;  // normal/test GC
        Memmgr_Debug cgen_Memmgr_Debug = GC_QUICK; // check heap frequently
@@ -48,12 +52,14 @@ void handle_flags(int argc, char *argv[]) {
   cool_yydebug = 0;
   lex_verbose  = 0;
   semant_debug = 0;
+  semant_jobs = 1;
   cgen_debug = 0;
   cgen_optimize = 0;
   disable_reg_alloc = 0;
+  ast_binary = 0;
   
 
-  while ((c = getopt(argc, argv, "lpscvrOo:gtT")) != -1) {
+  while ((c = getopt(argc, argv, "lpscvrOo:gtTbj:y:Y:")) != -1) {
     switch (c) {
 #ifdef DEBUG
     case 'l':
@@ -99,6 +105,20 @@ void handle_flags(int argc, char *argv[]) {
     case 'O':  // enable optimization
       cgen_optimize = 1;
       break;
+    case 'b':  // read/write the AST in the binary format of ast-binary.h
+      ast_binary = 1;
+      break;
+    case 'j':  // type check on this many threads
+      semant_jobs = atoi(optarg);
+      if (semant_jobs < 1)
+        semant_jobs = 1;
+      break;
+    case 'y':  // start from a symbol table snapshot, see stringtab.h
+      symbol_file = optarg;
+      break;
+    case 'Y':  // write the snapshot of the predefined symbols for -y
+      basic_symbols_file = optarg;
+      break;
     case '?':
       unknownopt = 1;
       break;
@@ -111,9 +131,9 @@ void handle_flags(int argc, char *argv[]) {
   if (unknownopt) {
       cerr << "usage: " << argv[0] << 
 #ifdef DEBUG
-	  " [-lvpscOgtTr -o outname] [input-files]\n";
+	  " [-lvpscOgtTrb -o outname -j jobs -y symbols -Y symbols] [input-files]\n";
 #else
-      " [-OgtT -o outname] [input-files]\n";
+      " [-OgtTb -o outname -j jobs -y symbols -Y symbols] [input-files]\n";
 #endif
       exit(1);
   }
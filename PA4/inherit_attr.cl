@@ -0,0 +1,16 @@
+class A {
+  x : Int <- 1;
+};
+
+class B inherits A {
+  y : Int <- x + 1;
+  get() : Int { x + y };
+};
+
+class C inherits B {
+  set(v : Int) : Int { x <- v };
+};
+
+class Main {
+  main() : Int { (new C).set((new B).get()) };
+};
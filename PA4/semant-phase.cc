@@ -1,19 +1,51 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include "cool-tree.h"
+#include "ast-binary.h"
 
 extern Program ast_root;      // root of the abstract syntax tree
 FILE *ast_file = stdin;       // we read the AST from standard input
 extern int ast_yyparse(void); // entry point to the AST parser
+extern int ast_binary;        // read/write the AST in binary (-b)
 
 int cool_yydebug;     // not used, but needed to link with handle_flags
 char *curr_filename;
 
+extern char *symbol_file;        // -y: symbol table snapshot to start from
+extern char *basic_symbols_file; // -Y: write the predefined symbols here
+extern bool write_basic_symbols(char *filename);
+
 void handle_flags(int argc, char *argv[]);
 
-int main(int argc, char *argv[]) {
+static int phase_main(int argc, char *argv[]) {
   handle_flags(argc,argv);
-  ast_yyparse();
+  if (basic_symbols_file) {
+    if (!write_basic_symbols(basic_symbols_file)) {
+      cerr << "Cannot write symbol table snapshot " << basic_symbols_file << endl;
+      exit(1);
+    }
+    exit(0);
+  }
+  if (symbol_file && !load_symbol_tables(symbol_file)) {
+    cerr << "Cannot load symbol table snapshot " << symbol_file << endl;
+    exit(1);
+  }
+  if (ast_binary)
+    ast_root = read_binary(ast_file);
+  else
+    ast_yyparse();
   ast_root->semant();
-  ast_root->dump_with_types(cout,0);
+  if (ast_binary)
+    dump_binary(cout, ast_root);
+  else
+    ast_root->dump_with_types(cout,0);
+  return 0;
 }
 
+//
+// Everything runs on a stack deep enough for deeply nested programs;
+// see run_on_ast_stack in tree.h.
+//
+int main(int argc, char *argv[]) {
+  return run_on_ast_stack(phase_main, argc, argv);
+}
@@ -7,12 +7,24 @@
 #include "utilities.h"
 #include <vector>
 #include <set>
+#include <atomic>
+#include <sstream>
 
 
 
 extern int semant_debug;
+extern int semant_jobs;
 extern char *curr_filename;
 
+// -j N 并行检查时, 每个任务的错误先写到自己的缓冲里, 全部查完再按源程序顺序输出.
+// task_errors 是当前线程正在做的任务的缓冲, 不在任务里时是 nullptr, 错误直接写 cerr
+struct TaskErrors {
+    std::ostringstream out;
+    int count = 0;
+};
+
+static thread_local TaskErrors* task_errors = nullptr;
+
 //////////////////////////////////////////////////////////////////////
 //
 // Symbols
@@ -84,13 +96,14 @@ static void initialize_constants(void)
     val         = idtable.add_string("_val");
 }
 
-static void add_class_attrs_to_env(Class_ c, SymbolTable<Symbol, Symbol>* env) {
-    Features fs = c->get_features();
-    for (int i = fs->first(); fs->more(i); i = fs->next(i)) {
-        Feature f = fs->nth(i);
-        attr_class* a = dynamic_cast<attr_class*>(f);
-        if (a) env->addid(a->get_name(), new Symbol(a->get_type_decl()));
-    }
+//
+// -Y: 把上面这些预定义符号存成快照, 之后 semant/cgen/coolc 用 -y 载入,
+// 这些符号的下标就固定下来了, 不用每次重新 intern (见 stringtab.h)
+//
+bool write_basic_symbols(char *filename)
+{
+    initialize_constants();
+    return save_symbol_tables(filename);
 }
 
  // helper: normalize SELF_TYPE to current_class for LUB/conforms computations
@@ -103,9 +116,113 @@ ClassTable::ClassTable(Classes classes)
     : classes(classes), semant_errors(0), error_stream(cerr) {
 
     install_basic_classes();
+    build_index();
+    number_classes();
+    build_features();
     // 先不做完整继承图检查，后面再补
 }
 
+// 把 classes 扫一遍建类名的索引. 方法表在编号以后由 build_features 建
+void ClassTable::build_index() {
+    for (int i = classes->first(); classes->more(i); i = classes->next(i)) {
+        Class_ c = classes->nth(i);
+        class_by_name.emplace(c->get_name(), c);
+    }
+}
+
+template <class T>
+static PrefixTable<T> empty_table() {
+    PrefixTable<T> t;
+    t.items = new std::vector<T>();
+    t.length = 0;
+    t.owned = true;
+    return t;
+}
+
+// 每个类的属性表和方法表. 按先序建, 轮到一个类时它父类的表已经建好了: 先拿父类的表
+// (和父类共用数组), 再接上自己的属性和方法, 不用沿继承链往上走.
+// 不在继承树里的类 (父类不存在或者成环) 没有建好的父类可用, 就沿 parent 往上收集,
+// 从最远的祖先到自己依次接上去, 同样最多走类的个数那么多步
+void ClassTable::build_features() {
+    for (size_t i = 0; i < class_at_pre.size(); i++) {
+        Symbol name = class_at_pre[i];
+        ClassFeatures& t = features_of[name];
+        if (i == 0) {
+            t.attrs = empty_table<AttrSig>();
+            t.methods = empty_table<MethodSig*>();
+        } else {
+            t = features_of[parent_of(name)];
+            t.attrs.owned = t.methods.owned = false;
+            for (int k = 0; k < t.methods.length; k++)
+                method_by_name[std::make_pair(name, t.methods[k]->name)] = t.methods[k];
+        }
+        add_own_features(name, class_by_name[name], t);
+    }
+
+    for (auto& entry : class_by_name) {
+        if (class_interval.count(entry.first)) continue;
+
+        std::vector<Class_> chain;
+        Symbol cur = entry.first;
+        for (size_t steps = 0; cur != No_class && steps <= class_by_name.size(); steps++) {
+            auto it = class_by_name.find(cur);
+            if (it == class_by_name.end()) break;
+            chain.push_back(it->second);
+            cur = it->second->get_parent();
+        }
+
+        ClassFeatures& t = features_of[entry.first];
+        t.attrs = empty_table<AttrSig>();
+        t.methods = empty_table<MethodSig*>();
+        for (size_t k = chain.size(); k-- > 0; )
+            add_own_features(entry.first, chain[k], t);
+    }
+}
+
+// 把类 c 自己定义的属性和方法接到 name 的表 t 上. 和已有方法同名的是重写, 占原来的 slot;
+// 同一个类里同名的方法定义了两次的话, 算第一个
+void ClassTable::add_own_features(Symbol name, Class_ c, ClassFeatures& t) {
+    Features fs = c->get_features();
+    for (int i = fs->first(); fs->more(i); i = fs->next(i)) {
+        Feature f = fs->nth(i);
+
+        attr_class* a = dynamic_cast<attr_class*>(f);
+        if (a) {
+            AttrSig as = { a->get_name(), a->get_type_decl() };
+            t.attrs.push(as);
+            continue;
+        }
+
+        method_class* m = dynamic_cast<method_class*>(f);
+        if (!m) continue;
+
+        std::pair<Symbol, Symbol> key = std::make_pair(name, m->get_name());
+        auto it = method_by_name.find(key);
+        if (it != method_by_name.end() && it->second->owner == c->get_name()) continue;
+
+        MethodSig* sig = new MethodSig;
+        sig->method = m;
+        sig->owner = c->get_name();
+        sig->name = m->get_name();
+        sig->return_type = m->get_return_type();
+        Formals formals = m->get_formals();
+        for (int k = formals->first(); formals->more(k); k = formals->next(k)) {
+            formal_class* ff = (formal_class*) formals->nth(k);
+            sig->formal_names.push_back(ff->get_name());
+            sig->formal_types.push_back(ff->get_type_decl());
+        }
+
+        if (it == method_by_name.end()) {
+            sig->slot = t.methods.length;
+            t.methods.push(sig);
+        } else {
+            sig->slot = it->second->slot;
+            t.methods.set(sig->slot, sig);
+        }
+        method_by_name[key] = sig;
+    }
+}
+
 
 void ClassTable::install_basic_classes() {
 
@@ -244,42 +361,174 @@ ostream& ClassTable::semant_error(Class_ c)
 
 ostream& ClassTable::semant_error(Symbol filename, tree_node *t)
 {
-    error_stream << filename << ":" << t->get_line_number() << ": ";
-    return semant_error();
+    ostream& s = semant_error();
+    s << filename << ":" << t->get_line_number() << ": ";
+    return s;
 }
 
 ostream& ClassTable::semant_error()                  
 {                                                 
+    if (task_errors) {
+        task_errors->count++;
+        return task_errors->out;
+    }
     semant_errors++;                            
     return error_stream;
 } 
 
-method_class* ClassTable::lookup_method(Symbol class_name, Symbol method_name) {
-    // 沿继承链向上找：class_name -> parent -> parent -> ...
-    Symbol cur = class_name;
-
-    while (cur != No_class) {
-        // 在 cur 这个类自身找
-        for (int i = classes->first(); classes->more(i); i = classes->next(i)) {
-            Class_ c = classes->nth(i);
-            if (c->get_name() != cur) continue;
-
-            Features fs = c->get_features();
-            for (int j = fs->first(); fs->more(j); j = fs->next(j)) {
-                Feature f = fs->nth(j);
-                method_class* m = dynamic_cast<method_class*>(f);
-                if (m && m->get_name() == method_name) return m;
-            }
-            break; // 找到类了但没找到方法，跳出去去父类
+MethodSig* ClassTable::lookup_method(Symbol class_name, Symbol method_name) {
+    // 继承链已经在 build_features 里展开了
+    auto it = method_by_name.find(std::make_pair(class_name, method_name));
+    return it == method_by_name.end() ? nullptr : it->second;
+}
+
+// 类的环境: self 和所有能看到的属性 (含继承的, 父类的先加, 子类同名的会挡住父类的)
+static void enter_class_env(ClassTable* classtable, Symbol current_class,
+                            SymbolTable<Symbol, Symbol>* obj_env) {
+    obj_env->enterscope();
+
+    // self : SELF_TYPE
+    obj_env->addid(self, new Symbol(SELF_TYPE));
+
+    const PrefixTable<AttrSig>& attrs = classtable->attrs_of(current_class);
+    for (int k = 0; k < attrs.length; k++)
+        obj_env->addid(attrs[k].name, new Symbol(attrs[k].type));
+}
+
+// 本类 attr initializer 的 typecheck
+static void check_attr_inits(ClassTable* classtable, Class_ c,
+                             SymbolTable<Symbol, Symbol>* obj_env) {
+    Symbol current_class = c->get_name();
+    Features fs = c->get_features();
+    for (int jj = fs->first(); fs->more(jj); jj = fs->next(jj)) {
+        Feature f2 = fs->nth(jj);
+        attr_class* a = dynamic_cast<attr_class*>(f2);
+        if (!a) continue;
+
+        // 取 init 表达式（如果没有就跳过）
+        Expression init = a->get_init();   // 注意：你的接口可能叫 get_init()
+        if (init) {
+            Symbol t_init = init->tc(classtable, current_class, obj_env);
+            // 如果你要检查 conforms，就再加 conforms 检查
         }
+    }
+}
 
-        cur = parent_of(cur);
+// 一个方法的 typecheck, obj_env 里已经有类的环境了
+static void check_method(ClassTable* classtable, Class_ c, method_class* m,
+                         SymbolTable<Symbol, Symbol>* obj_env) {
+    Symbol current_class = c->get_name();
+
+    obj_env->enterscope(); // ✅ 方法作用域
+
+    // 形参加入 env（x:Int, y:Bool）
+    Formals formals = m->get_formals();
+    for (int k = formals->first(); formals->more(k); k = formals->next(k)) {
+        Formal fo = formals->nth(k);
+        formal_class* ff = dynamic_cast<formal_class*>(fo);
+        if (ff) {
+            obj_env->addid(ff->get_name(), new Symbol(ff->get_type_decl()));
+        }
     }
 
-    return nullptr;
+    // 方法体 typecheck
+    Symbol inferred_ret = m->get_expr()->tc(classtable, current_class, obj_env);
+
+    // ====== Step2: 检查“推断返回类型” conforms “声明返回类型” ======
+    Symbol declared_ret = m->get_return_type();
+
+    // 比较时把 SELF_TYPE 当作 current_class
+    Symbol inferred_cmp = (inferred_ret == SELF_TYPE) ? current_class : inferred_ret;
+    Symbol declared_cmp = (declared_ret == SELF_TYPE) ? current_class : declared_ret;
+
+    if (!classtable->conforms(inferred_cmp, declared_cmp)) {
+        Symbol filename = classtable->filename_of(current_class);
+        classtable->semant_error(filename, m)
+            << "Inferred return type " << inferred_ret
+            << " of method " << m->get_name()
+            << " does not conform to declared return type " << declared_ret
+            << "." << endl;
+    }
+
+    obj_env->exitscope(); // ✅ 退出方法作用域
 }
 
+// -j N: 一个任务是一个类的全部 attr initializer (method == nullptr) 或者一个方法.
+// 任务之间互不依赖, ClassTable 建好以后只读, 每个任务的错误先写到自己的 errors 里
+struct SemantTask {
+    Class_ c;
+    method_class* method;
+    TaskErrors errors;
+};
+
+struct SemantPool {
+    ClassTable* classtable;
+    std::vector<SemantTask*> tasks;
+    std::atomic<size_t> next;
+};
+
+static void run_semant_task(ClassTable* classtable, SemantTask* t) {
+    SymbolTable<Symbol, Symbol> obj_env;
+    enter_class_env(classtable, t->c->get_name(), &obj_env);
+    if (t->method) check_method(classtable, t->c, t->method, &obj_env);
+    else check_attr_inits(classtable, t->c, &obj_env);
+    obj_env.exitscope();
+}
 
+// 每个线程不停地取下一个还没做的任务. 任务都不大, 一个共用的计数器就够分了
+static void semant_worker(void* arg) {
+    SemantPool* pool = (SemantPool*) arg;
+    for (size_t i; (i = pool->next++) < pool->tasks.size(); ) {
+        SemantTask* t = pool->tasks[i];
+        task_errors = &t->errors;
+        run_semant_task(pool->classtable, t);
+        task_errors = nullptr;
+    }
+}
+
+// 并行检查全部类, 然后按类在源程序里的顺序输出错误: 和一个线程时一样,
+// 第一个有错的类的错误输出完就停, 输出和顺序检查的完全相同
+static void semant_parallel(ClassTable* classtable, Classes classes) {
+    SemantPool pool;
+    pool.classtable = classtable;
+    pool.next = 0;
+    std::vector<int> class_end;   // 每个类最后一个任务之后的下标
+    for (int i = classes->first(); classes->more(i); i = classes->next(i)) {
+        Class_ c = classes->nth(i);
+        if (!dynamic_cast<class__class*>(c)) continue;
+
+        SemantTask* t = new SemantTask;
+        t->c = c;
+        t->method = nullptr;
+        pool.tasks.push_back(t);
+
+        Features fs = c->get_features();
+        for (int j = fs->first(); fs->more(j); j = fs->next(j)) {
+            method_class* m = dynamic_cast<method_class*>(fs->nth(j));
+            if (!m) continue;
+            t = new SemantTask;
+            t->c = c;
+            t->method = m;
+            pool.tasks.push_back(t);
+        }
+        class_end.push_back(pool.tasks.size());
+    }
+
+    run_on_ast_threads(semant_jobs, semant_worker, &pool);
+
+    size_t k = 0;
+    for (size_t i = 0; i < class_end.size(); i++) {
+        int errors = 0;
+        for (; k < (size_t) class_end[i]; k++) {
+            cerr << pool.tasks[k]->errors.out.str();
+            errors += pool.tasks[k]->errors.count;
+        }
+        if (errors) {
+            cerr << "Compilation halted due to static semantic errors." << endl;
+            exit(1);
+        }
+    }
+}
 
 /*   This is the entry point to the semantic checker.
 
@@ -305,78 +554,32 @@ void program_class::semant()
         exit(1);
     }
 
+    // -H 的共享子树只在第一次碰到时检查 (见 tc_cached), 哪个类先碰到决定了错误报在哪,
+    // 所以这时还是一个类一个类地查
+    if (semant_jobs > 1 && !hash_cons_ast) {
+        semant_parallel(classtable, classes);
+        return;
+    }
+
     // ====== 新增：类型检查 & 标注 ======
     for (int i = classes->first(); classes->more(i); i = classes->next(i)) {
         Class_ c = classes->nth(i);
         class__class* cc = dynamic_cast<class__class*>(c);
         if (!cc) continue;
 
-        Symbol current_class = c->get_name();
         Features fs = c->get_features();
 
         // ✅ 每个 class 只建一次 obj_env
         SymbolTable<Symbol, Symbol> obj_env;
-        obj_env.enterscope();
-
-        // self : SELF_TYPE
-        obj_env.addid(self, new Symbol(SELF_TYPE));
-
-        // 属性加入 env（含继承的）
-        add_class_attrs_to_env(c, &obj_env);
+        enter_class_env(classtable, c->get_name(), &obj_env);
 
         // ✅ 第3步：在这里跑“本类 attr initializer”的 typecheck（只跑一次）
-       for (int jj = fs->first(); fs->more(jj); jj = fs->next(jj)) {
-            Feature f2 = fs->nth(jj);
-            attr_class* a = dynamic_cast<attr_class*>(f2);
-            if (!a) continue;
-
-            // 取 init 表达式（如果没有就跳过）
-            Expression init = a->get_init();   // 注意：你的接口可能叫 get_init()
-            if (init) {
-                Symbol t_init = init->tc(classtable, current_class, &obj_env);
-                // 如果你要检查 conforms，就再加 conforms 检查
-            }
-        }
+        check_attr_inits(classtable, c, &obj_env);
 
         // 再跑每个 method
         for (int j = fs->first(); fs->more(j); j = fs->next(j)) {
-            Feature f = fs->nth(j);
-            method_class* m = dynamic_cast<method_class*>(f);
-            if (!m) continue;
-
-            obj_env.enterscope(); // ✅ 方法作用域
-
-            // 形参加入 env（x:Int, y:Bool）
-            Formals formals = m->get_formals();
-            for (int k = formals->first(); formals->more(k); k = formals->next(k)) {
-                Formal fo = formals->nth(k);
-                formal_class* ff = dynamic_cast<formal_class*>(fo);
-                if (ff) {
-                    obj_env.addid(ff->get_name(), new Symbol(ff->get_type_decl()));
-                }
-            }
-
-            // 方法体 typecheck
-            Symbol inferred_ret = m->get_expr()->tc(classtable, current_class, &obj_env);
-
-            // ====== Step2: 检查“推断返回类型” conforms “声明返回类型” ======
-            Symbol declared_ret = m->get_return_type();
-
-            // 比较时把 SELF_TYPE 当作 current_class
-            Symbol inferred_cmp = (inferred_ret == SELF_TYPE) ? current_class : inferred_ret;
-            Symbol declared_cmp = (declared_ret == SELF_TYPE) ? current_class : declared_ret;
-
-            if (!classtable->conforms(inferred_cmp, declared_cmp)) {
-                Symbol filename = classtable->filename_of(current_class);
-                classtable->semant_error(filename, m)
-                    << "Inferred return type " << inferred_ret
-                    << " of method " << m->get_name()
-                    << " does not conform to declared return type " << declared_ret
-                    << "." << endl;
-            }
-
-
-            obj_env.exitscope(); // ✅ 退出方法作用域
+            method_class* m = dynamic_cast<method_class*>(fs->nth(j));
+            if (m) check_method(classtable, c, m, &obj_env);
         }
 
         obj_env.exitscope(); // ✅ 退出 class 作用域
@@ -394,8 +597,17 @@ bool ClassTable::conforms(Symbol child, Symbol parent) {
     if (child == No_type) return true;   // No_type 视为可赋值给任何类型（常见约定）
     if (parent == Object) return true;
 
+    // 两次整数比较 (见 number_classes)
+    auto c = class_interval.find(child);
+    if (c != class_interval.end()) {
+        auto p = class_interval.find(parent);
+        return p != class_interval.end() &&
+               p->second.pre <= c->second.pre && c->second.post <= p->second.post;
+    }
+
+    // child 不在继承树里: 沿 parent 找, 最多走类的个数那么多步 (防环)
     Symbol cur = child;
-    while (cur != No_class) {
+    for (size_t steps = 0; cur != No_class && steps <= class_by_name.size(); steps++) {
         if (cur == parent) return true;
         cur = parent_of(cur);
     }
@@ -409,38 +621,110 @@ Symbol ClassTable::lub(Symbol a, Symbol b) {
     // 注意：lub 本身不应该把 SELF_TYPE 直接变 Object
     // SELF_TYPE 的处理应该在调用 lub 之前先“规范化”为 current_class
 
-    // 记录 a 的所有祖先
-    std::set<Symbol> ancestors;
-    Symbol cur = a;
-    while (cur != No_class) {
-        ancestors.insert(cur);
-        cur = parent_of(cur);
-    }
+    // 两个都在继承树里: 就是树上的 LCA (见 lca_pre)
+    auto ia = class_interval.find(a);
+    auto ib = class_interval.find(b);
+    if (ia != class_interval.end() && ib != class_interval.end())
+        return class_at_pre[lca_pre(ia->second.pre, ib->second.pre)];
 
-    // 从 b 向上找第一个在 ancestors 里的
-    cur = b;
-    while (cur != No_class) {
-        if (ancestors.count(cur)) return cur;
+    // 否则从 b 往上找第一个 a conforms 的祖先, 同样最多走类的个数那么多步
+    Symbol cur = b;
+    for (size_t steps = 0; cur != No_class && steps <= class_by_name.size(); steps++) {
+        if (conforms(a, cur)) return cur;
         cur = parent_of(cur);
     }
 
     return Object; // 保底
 }
 
+// 一组类型的 lub. 树上一组结点的 LCA 就是其中 pre 最小和 pre 最大的两个的 LCA,
+// 所以不管 case 有多少个分支, 只扫一遍再求一次 LCA. 不在树里的类型还是两两求
+Symbol ClassTable::lub(const std::vector<Symbol>& types) {
+    Symbol result = No_type;
+    int lo = -1, hi = -1;
+    for (size_t i = 0; i < types.size(); i++) {
+        if (types[i] == No_type) continue;
+        auto it = class_interval.find(types[i]);
+        if (it == class_interval.end()) {
+            result = lub(result, types[i]);
+            continue;
+        }
+        int p = it->second.pre;
+        if (lo < 0 || p < lo) lo = p;
+        if (hi < 0 || p > hi) hi = p;
+    }
+    if (lo >= 0) result = lub(result, class_at_pre[lca_pre(lo, hi)]);
+    return result;
+}
+
+// 倍增求 LCA: a 不是 b 的祖先时, 从大步到小步往上跳, 只要跳到的还不是 b 的祖先就跳,
+// 最后 a 的父类就是 LCA. O(log 类的个数), 不分配内存
+int ClassTable::lca_pre(int a, int b) {
+    if (ancestor_pre(a, b)) return a;
+    if (ancestor_pre(b, a)) return b;
+    for (int k = (int) up.size() - 1; k >= 0; k--)
+        if (!ancestor_pre(up[k][a], b)) a = up[k][a];
+    return up[0][a];
+}
 
-Symbol ClassTable::parent_of(Symbol class_name) {
+
+// 给继承树编号 (见 semant.h 的 class_interval). 用显式的栈, 继承链很深也不会爆栈;
+// 子类按在 classes 里出现的顺序走. 父类不存在或者成环的类从 Object 走不到,
+// 就不编号, conforms 对它们还是沿着 parent 一步步找
+void ClassTable::number_classes() {
+    std::unordered_map<Symbol, std::vector<Symbol>> children;
     for (int i = classes->first(); classes->more(i); i = classes->next(i)) {
         Class_ c = classes->nth(i);
-        if (c->get_name() == class_name) return c->get_parent();
+        if (c->get_name() == Object || class_by_name[c->get_name()] != c) continue;
+        children[c->get_parent()].push_back(c->get_name());
     }
+
+    int pre = 0, post = 0;                          // 先序, 后序各自从 0 数
+    std::vector<int> parent_pre;                    // 下标是 pre 编号
+    std::vector<std::pair<Symbol, size_t>> stack;   // (类, 下一个要走的子类)
+    class_interval[Object].pre = pre++;
+    class_at_pre.push_back(Object);
+    parent_pre.push_back(0);                        // Object 的父类当成它自己
+    stack.push_back(std::make_pair(Object, (size_t) 0));
+    while (!stack.empty()) {
+        Symbol cur = stack.back().first;
+        std::vector<Symbol>& kids = children[cur];
+        size_t k = stack.back().second++;
+        if (k < kids.size()) {
+            if (class_interval.count(kids[k])) continue;
+            parent_pre.push_back(class_interval[cur].pre);
+            class_at_pre.push_back(kids[k]);
+            class_interval[kids[k]].pre = pre++;
+            stack.push_back(std::make_pair(kids[k], (size_t) 0));
+        } else {
+            class_interval[cur].post = post++;
+            stack.pop_back();
+        }
+    }
+
+    int n = class_at_pre.size();
+    post_at_pre.resize(n);
+    for (int i = 0; i < n; i++) post_at_pre[i] = class_interval[class_at_pre[i]].post;
+
+    // up[k][i]: 往上第 2^k 个祖先, 层数够覆盖最深的继承链就行
+    up.push_back(parent_pre);
+    while ((1 << up.size()) < n) {
+        std::vector<int>& prev = up.back();
+        std::vector<int> next(n);
+        for (int i = 0; i < n; i++) next[i] = prev[prev[i]];
+        up.push_back(next);
+    }
+}
+
+Symbol ClassTable::parent_of(Symbol class_name) {
+    auto it = class_by_name.find(class_name);
+    if (it != class_by_name.end()) return it->second->get_parent();
     return No_class; // 找不到就返回 No_class
 }
 
 Symbol ClassTable::filename_of(Symbol class_name) {
-    for (int i = classes->first(); classes->more(i); i = classes->next(i)) {
-        Class_ c = classes->nth(i);
-        if (c->get_name() == class_name) return c->get_filename();
-    }
+    auto it = class_by_name.find(class_name);
+    if (it != class_by_name.end()) return it->second->get_filename();
     return stringtable.add_string("<unknown>");
 }
 
@@ -558,14 +842,22 @@ Symbol string_const_class::tc(ClassTable* ct, Symbol current_class,
     return Str;
 }
 
+// hash-cons 打开时 (见 tree.h) 一样的常量表达式只有一个节点, 类型又和出现的位置无关,
+// 所以第二次走到同一个节点时直接返回第一次算出来的类型, 不再把子树查一遍
+static inline bool tc_cached(Expression_class* e) {
+    return e->get_type() != NULL && shared_id(e) != 0;
+}
+
 Symbol isvoid_class::tc(ClassTable* ct, Symbol current_class,
                         SymbolTable<Symbol, Symbol>* obj_env) {
+    if (tc_cached(this)) return get_type();
     e1->tc(ct, current_class, obj_env);
     set_type(Bool);
     return Bool;
 }
 Symbol neg_class::tc(ClassTable* ct, Symbol current_class,
                      SymbolTable<Symbol, Symbol>* obj_env) {
+    if (tc_cached(this)) return get_type();
     e1->tc(ct, current_class, obj_env);
     set_type(Int);
     return Int;
@@ -573,6 +865,7 @@ Symbol neg_class::tc(ClassTable* ct, Symbol current_class,
 
 Symbol comp_class::tc(ClassTable* ct, Symbol current_class,
                       SymbolTable<Symbol, Symbol>* obj_env) {
+    if (tc_cached(this)) return get_type();
     e1->tc(ct, current_class, obj_env);
     set_type(Bool);
     return Bool;
@@ -580,6 +873,7 @@ Symbol comp_class::tc(ClassTable* ct, Symbol current_class,
 
 Symbol plus_class::tc(ClassTable* ct, Symbol current_class,
                       SymbolTable<Symbol, Symbol>* obj_env) {
+    if (tc_cached(this)) return get_type();
     e1->tc(ct, current_class, obj_env);
     e2->tc(ct, current_class, obj_env);
     set_type(Int);
@@ -587,6 +881,7 @@ Symbol plus_class::tc(ClassTable* ct, Symbol current_class,
 }
 Symbol sub_class::tc(ClassTable* ct, Symbol current_class,
                      SymbolTable<Symbol, Symbol>* obj_env) {
+    if (tc_cached(this)) return get_type();
     e1->tc(ct, current_class, obj_env);
     e2->tc(ct, current_class, obj_env);
     set_type(Int);
@@ -594,6 +889,7 @@ Symbol sub_class::tc(ClassTable* ct, Symbol current_class,
 }
 Symbol mul_class::tc(ClassTable* ct, Symbol current_class,
                      SymbolTable<Symbol, Symbol>* obj_env) {
+    if (tc_cached(this)) return get_type();
     e1->tc(ct, current_class, obj_env);
     e2->tc(ct, current_class, obj_env);
     set_type(Int);
@@ -601,6 +897,7 @@ Symbol mul_class::tc(ClassTable* ct, Symbol current_class,
 }
 Symbol divide_class::tc(ClassTable* ct, Symbol current_class,
                         SymbolTable<Symbol, Symbol>* obj_env) {
+    if (tc_cached(this)) return get_type();
     e1->tc(ct, current_class, obj_env);
     e2->tc(ct, current_class, obj_env);
     set_type(Int);
@@ -609,6 +906,7 @@ Symbol divide_class::tc(ClassTable* ct, Symbol current_class,
 
 Symbol lt_class::tc(ClassTable* ct, Symbol current_class,
                     SymbolTable<Symbol, Symbol>* obj_env) {
+    if (tc_cached(this)) return get_type();
     e1->tc(ct, current_class, obj_env);
     e2->tc(ct, current_class, obj_env);
     set_type(Bool);
@@ -616,6 +914,7 @@ Symbol lt_class::tc(ClassTable* ct, Symbol current_class,
 }
 Symbol leq_class::tc(ClassTable* ct, Symbol current_class,
                      SymbolTable<Symbol, Symbol>* obj_env) {
+    if (tc_cached(this)) return get_type();
     e1->tc(ct, current_class, obj_env);
     e2->tc(ct, current_class, obj_env);
     set_type(Bool);
@@ -623,6 +922,7 @@ Symbol leq_class::tc(ClassTable* ct, Symbol current_class,
 }
 Symbol eq_class::tc(ClassTable* ct, Symbol current_class,
                     SymbolTable<Symbol, Symbol>* obj_env) {
+    if (tc_cached(this)) return get_type();
     e1->tc(ct, current_class, obj_env);
     e2->tc(ct, current_class, obj_env);
     set_type(Bool);
@@ -703,6 +1003,7 @@ Symbol typcase_class::tc(ClassTable* ct, Symbol current_class,
 
     Symbol result_type = No_type;
     std::set<Symbol> seen_branch_types;
+    std::vector<Symbol> branch_types;
 
     bool all_selftype = true;  // 新增：记录是否所有 branch expr 的类型都是 SELF_TYPE
 
@@ -730,16 +1031,11 @@ Symbol typcase_class::tc(ClassTable* ct, Symbol current_class,
         if (t != SELF_TYPE) all_selftype = false;
 
         // 求 lub 时，SELF_TYPE 用 current_class 参与比较
-        Symbol t_cmp = (t == SELF_TYPE) ? current_class : t;
-
-        if (result_type == No_type) {
-            result_type = t_cmp;
-        } else {
-            Symbol res_cmp = (result_type == SELF_TYPE) ? current_class : result_type;
-            result_type = ct->lub(res_cmp, t_cmp);
-        }
+        branch_types.push_back((t == SELF_TYPE) ? current_class : t);
     }
 
+    // 所有分支一起求一次 lub
+    result_type = ct->lub(branch_types);
     if (result_type == No_type) result_type = Object;
 
     // 关键：如果所有分支表达式的类型都是 SELF_TYPE，则 case 的结果类型也应该是 SELF_TYPE
@@ -772,7 +1068,7 @@ Symbol dispatch_class::tc(ClassTable* ct, Symbol current_class,
         Symbol dispatch_class_name = recv_t;
         if (recv_t == SELF_TYPE) dispatch_class_name = current_class;
 
-        method_class* m = ct->lookup_method(dispatch_class_name, name);
+        MethodSig* m = ct->lookup_method(dispatch_class_name, name);
         if (!m) {
             ct->semant_error(filename, this)
             << "Dispatch to undefined method " << name << "." << endl;
@@ -781,9 +1077,7 @@ Symbol dispatch_class::tc(ClassTable* ct, Symbol current_class,
         }
 
         // 4) 参数个数检查
-        Formals formals = m->get_formals();
-        int n_formals = 0;
-        for (int k = formals->first(); formals->more(k); k = formals->next(k)) n_formals++;
+        int n_formals = m->formal_types.size();
 
         if ((int)actual_types.size() != n_formals) {
             ct->semant_error(filename, this)
@@ -791,14 +1085,8 @@ Symbol dispatch_class::tc(ClassTable* ct, Symbol current_class,
         } else {
         
         // 5) 参数类型检查（用 conforms + SELF_TYPE 处理）
-        int ai = 0;
-        Symbol recv_lookup = (recv_t == SELF_TYPE) ? current_class : recv_t;
-        for (int k = formals->first(); formals->more(k); k = formals->next(k), ai++) {
-            // Formal 在 PA4 里本来就是 formal_class*，不需要 dynamic_cast
-            formal_class* ff = (formal_class*) formals->nth(k);
-            if (ff == nullptr) continue; // 防御：避免崩溃
-
-            Symbol declared = ff->get_type_decl();
+        for (int ai = 0; ai < n_formals; ai++) {
+            Symbol declared = m->formal_types[ai];
             Symbol given    = actual_types[ai];
 
             // declared = SELF_TYPE（若你保留这条规则）：只有 SELF_TYPE 才能传给 SELF_TYPE
@@ -807,7 +1095,7 @@ Symbol dispatch_class::tc(ClassTable* ct, Symbol current_class,
                     ct->semant_error(filename, this)
                       << "In call of method " << name
                       << ", type " << given
-                      << " of parameter " << ff->get_name()
+                      << " of parameter " << m->formal_names[ai]
                       << " does not conform to declared type " << declared
                       << "." << endl;
                 }
@@ -818,7 +1106,7 @@ Symbol dispatch_class::tc(ClassTable* ct, Symbol current_class,
                     ct->semant_error(filename, this)
                       << "In call of method " << name
                       << ", type " << given
-                      << " of parameter " << ff->get_name()
+                      << " of parameter " << m->formal_names[ai]
                       << " does not conform to declared type " << declared
                       << "." << endl;
                 }
@@ -834,7 +1122,7 @@ Symbol dispatch_class::tc(ClassTable* ct, Symbol current_class,
             receiver_static = SELF_TYPE;
         }
 
-        Symbol ret = m->get_return_type();
+        Symbol ret = m->return_type;
         if (ret == SELF_TYPE) {
             // 如果 receiver 静态类型是 SELF_TYPE，结果仍是 SELF_TYPE
             // 否则结果是 receiver 的静态类型（例如 IO）
@@ -877,7 +1165,7 @@ Symbol static_dispatch_class::tc(ClassTable* ct, Symbol current_class,
     }
 
     // 4) 在指定的静态类型 type_name 上查方法
-    method_class* m = ct->lookup_method(target_cmp, name);
+    MethodSig* m = ct->lookup_method(target_cmp, name);
     if (!m) {
         ct->semant_error(filename, this)
           << "Dispatch to undefined method " << name << "." << endl;
@@ -886,18 +1174,14 @@ Symbol static_dispatch_class::tc(ClassTable* ct, Symbol current_class,
     }
 
     // 5) 参数个数与类型检查（用 conforms，而不是 ==）
-    Formals formals = m->get_formals();
-    int n_formals = 0;
-    for (int k = formals->first(); formals->more(k); k = formals->next(k)) n_formals++;
+    int n_formals = m->formal_types.size();
 
     if ((int)actual_types.size() != n_formals) {
         ct->semant_error(filename, this)
           << "Method " << name << " called with wrong number of arguments." << endl;
     } else {
-        int ai = 0;
-        for (int k = formals->first(); formals->more(k); k = formals->next(k), ai++) {
-            formal_class* ff = (formal_class*) formals->nth(k);
-            Symbol declared = ff->get_type_decl();
+        for (int ai = 0; ai < n_formals; ai++) {
+            Symbol declared = m->formal_types[ai];
             Symbol given = actual_types[ai];
 
             Symbol given_cmp = (given == SELF_TYPE) ? current_class : given;
@@ -908,7 +1192,7 @@ Symbol static_dispatch_class::tc(ClassTable* ct, Symbol current_class,
                 ct->semant_error(filename, this)
                   << "In call of method " << name
                   << ", type " << given
-                  << " of parameter " << ff->get_name()
+                  << " of parameter " << m->formal_names[ai]
                   << " does not conform to declared type " << declared
                   << "." << endl;
             }
@@ -918,7 +1202,7 @@ Symbol static_dispatch_class::tc(ClassTable* ct, Symbol current_class,
     // 6) 返回类型：如果方法声明返回 SELF_TYPE
     //    注意：static dispatch 返回 SELF_TYPE 时，结果应该是 “receiver 的静态类型”：
     //    a@A.g(): SELF_TYPE  ==> A
-        Symbol ret = m->get_return_type();
+        Symbol ret = m->return_type;
         if (ret == SELF_TYPE) {
             // static dispatch：SELF_TYPE 按 @T 的 T 来解析
             ret = type_name;   // 这里的 type_name 就是 @T 的 T
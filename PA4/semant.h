@@ -3,6 +3,9 @@
 
 #include <assert.h>
 #include <iostream>  
+#include <unordered_map>
+#include <utility>
+#include <vector>
 #include "cool-tree.h"
 #include "stringtab.h"
 #include "symtab.h"
@@ -14,6 +17,70 @@
 class ClassTable;
 typedef ClassTable *ClassTableP;
 
+// (类名, 方法名) 的 hash, 给 ClassTable 的方法表用
+struct SymbolPairHash {
+  size_t operator()(const std::pair<Symbol, Symbol>& p) const {
+    size_t h = (size_t) p.first * 0x9e3779b97f4a7c15ULL ^ (size_t) p.second;
+    return h ^ (h >> 29);
+  }
+};
+
+// 一个方法的签名: 形参的名字和类型各放一个数组, 检查 dispatch 时按下标取,
+// 不用再走 Formals. slot 是它在所属类方法表里的位置, 重写的方法和被重写的同一个 slot
+struct MethodSig {
+  method_class* method;
+  Symbol owner;                      // 定义它的类
+  Symbol name;
+  std::vector<Symbol> formal_names;
+  std::vector<Symbol> formal_types;
+  Symbol return_type;
+  int slot;
+};
+
+struct AttrSig {
+  Symbol name;
+  Symbol type;
+};
+
+// 一个类能看到的全部属性 / 方法 (含继承的), 父类的在前: 就是 items 的前 length 个.
+// 跟 tree.h 的 list_items 一个思路, 子类的表接在父类的表后面, 父类的数组后面还
+// 没被别人接过就直接接在原地, 所以一条继承链上的类共用一个数组. owned 表示
+// items 是这个类自己复制出来的, 改里面的元素 (重写方法) 不会影响别的类
+template <class T>
+struct PrefixTable {
+  std::vector<T>* items;
+  int length;
+  bool owned;
+
+  const T& operator[](int i) const { return (*items)[i]; }
+  void push(const T& x);
+  void set(int i, const T& x);
+};
+
+template <class T>
+void PrefixTable<T>::push(const T& x) {
+  if ((int) items->size() != length) {
+    items = new std::vector<T>(items->begin(), items->begin() + length);
+    owned = true;
+  }
+  items->push_back(x);
+  length++;
+}
+
+template <class T>
+void PrefixTable<T>::set(int i, const T& x) {
+  if (!owned) {
+    items = new std::vector<T>(items->begin(), items->begin() + length);
+    owned = true;
+  }
+  (*items)[i] = x;
+}
+
+struct ClassFeatures {
+  PrefixTable<AttrSig> attrs;
+  PrefixTable<MethodSig*> methods;
+};
+
 // This is a structure that may be used to contain the semantic
 // information such as the inheritance graph.  You may use it or not as
 // you like: it is only here to provide a container for the supplied
@@ -24,8 +91,33 @@ private:
   // 新增：保存 program 的 classes，方便查方法
   Classes classes;
 
+  // 构造函数里建一次的索引, 下面几个查询都是 O(1), 不用每次扫 classes:
+  // 类名 -> 类 (同名的取第一个), (类名, 方法名) -> 方法签名 (继承来的也放进去了),
+  // 类名 -> 这个类的属性表和方法表 (见 build_features)
+  std::unordered_map<Symbol, Class_> class_by_name;
+  std::unordered_map<std::pair<Symbol, Symbol>, MethodSig*, SymbolPairHash> method_by_name;
+  std::unordered_map<Symbol, ClassFeatures> features_of;
+
+  // 继承树从 Object 开始的 DFS 编号: 进一个类时给 pre, 出来时给 post.
+  // b 是 a 的祖先 (或就是 a) 当且仅当 pre[b] <= pre[a] 且 post[a] <= post[b].
+  // cgen 的 class tag 就是同样顺序的先序编号 (见 CgenClassTable::GetClassNodes)
+  struct ClassInterval { int pre, post; };
+  std::unordered_map<Symbol, ClassInterval> class_interval;
+
+  // 求 lub 用的倍增表, 下标都是 pre 编号: class_at_pre[i] 是编号 i 的类,
+  // post_at_pre[i] 是它的 post, up[k][i] 是它往上第 2^k 个祖先 (到 Object 为止)
+  std::vector<Symbol> class_at_pre;
+  std::vector<int> post_at_pre;
+  std::vector<std::vector<int>> up;
+  bool ancestor_pre(int a, int b) { return a <= b && post_at_pre[b] <= post_at_pre[a]; }
+  int lca_pre(int a, int b);
+
   int semant_errors;
   void install_basic_classes();
+  void build_index();
+  void number_classes();
+  void build_features();
+  void add_own_features(Symbol name, Class_ c, ClassFeatures& t);
   ostream& error_stream;
 
 public:
@@ -34,12 +126,16 @@ public:
 
   bool conforms(Symbol child, Symbol parent);
   Symbol lub(Symbol a, Symbol b);
+  Symbol lub(const std::vector<Symbol>& types);   // 一组类型的 lub, No_type 跳过
 
   ClassTable(Classes);
   int errors() { return semant_errors; }
   
-  // 新增：查找某个类里某个方法（先不走继承链，后面再扩展）
-  method_class* lookup_method(Symbol class_name, Symbol method_name);
+  // 查找某个类里某个方法（包括继承来的）, 找不到返回 nullptr
+  MethodSig* lookup_method(Symbol class_name, Symbol method_name);
+  // 某个类能看到的全部属性 (包括继承来的), 父类的在前. 类表建好以后上面这些查询都只读,
+  // 可以在多个线程里同时调 (-j)
+  const PrefixTable<AttrSig>& attrs_of(Symbol class_name) { return features_of.at(class_name).attrs; }
 
   ostream& semant_error();
   ostream& semant_error(Class_ c);
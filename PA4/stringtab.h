@@ -0,0 +1 @@
+../PA2/stringtab.h
\ No newline at end of file
@@ -0,0 +1 @@
+../PA3/tree.h
\ No newline at end of file
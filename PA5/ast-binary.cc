@@ -0,0 +1,681 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////
+//
+//  ast-binary.cc
+//
+//  Writer and reader for the binary AST described in ast-binary.h.
+//
+//  Writing is a recursive traversal like dump_with_types in
+//  dumptype.cc: every kind of node has a dump_binary method that puts
+//  its tag, line number and fields into an AstWriter.
+//
+//  Reading is a single pass over the image with a cursor.  Nodes are
+//  rebuilt through the ordinary constructors (program, class_, plus,
+//  ...) after setting node_lineno, exactly as the parsers do.
+//
+//////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "cool-io.h"
+#include "ast-binary.h"
+
+extern int node_lineno;
+
+///////////////////////////////////////////////////////////////////
+//
+// AstWriter
+//
+///////////////////////////////////////////////////////////////////
+
+static void put_varint(std::string& out, unsigned int v)
+{
+  while (v >= 0x80) {
+    out += (char) (v | 0x80);
+    v >>= 7;
+  }
+  out += (char) v;
+}
+
+static void put_u32(std::string& out, unsigned int v)
+{
+  for (int i = 0; i < 4; i++)
+    out += (char) ((v >> (8 * i)) & 0xff);
+}
+
+void AstWriter::put_varint(unsigned int v)
+{
+  ::put_varint(m_nodes, v);
+}
+
+void AstWriter::put_node(AstTag tag, tree_node *t)
+{
+  m_nodes += (char) tag;
+  put_varint(t->get_line_number());
+}
+
+//
+// Symbols are numbered per table in the order they are first written.
+//
+int AstWriter::symbol_index(int table, Symbol sym)
+{
+  std::unordered_map<Symbol, int>::iterator it = m_index[table].find(sym);
+  if (it == m_index[table].end()) {
+    it = m_index[table].insert(std::make_pair(sym, (int) m_symbols[table].size())).first;
+    m_symbols[table].push_back(sym);
+  }
+  return it->second;
+}
+
+void AstWriter::put_symbol(int table, Symbol sym)
+{
+  put_varint(symbol_index(table, sym));
+}
+
+void AstWriter::put_type(Symbol sym)
+{
+  put_varint(sym ? symbol_index(ID_TABLE, sym) + 1 : 0);
+}
+
+void AstWriter::put_table(std::string& out, int table)
+{
+  std::vector<Symbol>& syms = m_symbols[table];
+  ::put_varint(out, syms.size());
+  for (size_t i = 0; i < syms.size(); i++) {
+    ::put_varint(out, syms[i]->get_len());
+    out.append(syms[i]->get_string(), syms[i]->get_len());
+    out += '\0';
+  }
+}
+
+void AstWriter::finish(ostream& s)
+{
+  std::string tables;
+  put_table(tables, ID_TABLE);
+  put_table(tables, INT_TABLE);
+  put_table(tables, STR_TABLE);
+
+  std::string header(AST_BINARY_MAGIC);
+  put_u32(header, AST_BINARY_VERSION);
+  put_u32(header, tables.size() + m_nodes.size());
+
+  s.write(header.data(), header.size());
+  s.write(tables.data(), tables.size());
+  s.write(m_nodes.data(), m_nodes.size());
+}
+
+void dump_binary(ostream& s, Program p)
+{
+  AstWriter w;
+  p->dump_binary(w);
+  w.finish(s);
+}
+
+///////////////////////////////////////////////////////////////////
+//
+// dump_binary for every kind of node
+//
+///////////////////////////////////////////////////////////////////
+
+void program_class::dump_binary(AstWriter& w)
+{
+  w.put_node(AST_PROGRAM, this);
+  w.put_varint(classes->len());
+  for (int i = classes->first(); classes->more(i); i = classes->next(i))
+    classes->nth(i)->dump_binary(w);
+}
+
+void class__class::dump_binary(AstWriter& w)
+{
+  w.put_node(AST_CLASS, this);
+  w.put_id(name);
+  w.put_id(parent);
+  w.put_varint(features->len());
+  for (int i = features->first(); features->more(i); i = features->next(i))
+    features->nth(i)->dump_binary(w);
+  w.put_string(filename);
+}
+
+void method_class::dump_binary(AstWriter& w)
+{
+  w.put_node(AST_METHOD, this);
+  w.put_id(name);
+  w.put_varint(formals->len());
+  for (int i = formals->first(); formals->more(i); i = formals->next(i))
+    formals->nth(i)->dump_binary(w);
+  w.put_id(return_type);
+  expr->dump_binary(w);
+}
+
+void attr_class::dump_binary(AstWriter& w)
+{
+  w.put_node(AST_ATTR, this);
+  w.put_id(name);
+  w.put_id(type_decl);
+  init->dump_binary(w);
+}
+
+void formal_class::dump_binary(AstWriter& w)
+{
+  w.put_node(AST_FORMAL, this);
+  w.put_id(name);
+  w.put_id(type_decl);
+}
+
+void branch_class::dump_binary(AstWriter& w)
+{
+  w.put_node(AST_BRANCH, this);
+  w.put_id(name);
+  w.put_id(type_decl);
+  expr->dump_binary(w);
+}
+
+void assign_class::dump_binary(AstWriter& w)
+{
+  w.put_node(AST_ASSIGN, this);
+  w.put_id(name);
+  expr->dump_binary(w);
+  w.put_type(type);
+}
+
+void static_dispatch_class::dump_binary(AstWriter& w)
+{
+  w.put_node(AST_STATIC_DISPATCH, this);
+  expr->dump_binary(w);
+  w.put_id(type_name);
+  w.put_id(name);
+  w.put_varint(actual->len());
+  for (int i = actual->first(); actual->more(i); i = actual->next(i))
+    actual->nth(i)->dump_binary(w);
+  w.put_type(type);
+}
+
+void dispatch_class::dump_binary(AstWriter& w)
+{
+  w.put_node(AST_DISPATCH, this);
+  expr->dump_binary(w);
+  w.put_id(name);
+  w.put_varint(actual->len());
+  for (int i = actual->first(); actual->more(i); i = actual->next(i))
+    actual->nth(i)->dump_binary(w);
+  w.put_type(type);
+}
+
+void cond_class::dump_binary(AstWriter& w)
+{
+  w.put_node(AST_COND, this);
+  pred->dump_binary(w);
+  then_exp->dump_binary(w);
+  else_exp->dump_binary(w);
+  w.put_type(type);
+}
+
+void loop_class::dump_binary(AstWriter& w)
+{
+  w.put_node(AST_LOOP, this);
+  pred->dump_binary(w);
+  body->dump_binary(w);
+  w.put_type(type);
+}
+
+void typcase_class::dump_binary(AstWriter& w)
+{
+  w.put_node(AST_TYPCASE, this);
+  expr->dump_binary(w);
+  w.put_varint(cases->len());
+  for (int i = cases->first(); cases->more(i); i = cases->next(i))
+    cases->nth(i)->dump_binary(w);
+  w.put_type(type);
+}
+
+void block_class::dump_binary(AstWriter& w)
+{
+  w.put_node(AST_BLOCK, this);
+  w.put_varint(body->len());
+  for (int i = body->first(); body->more(i); i = body->next(i))
+    body->nth(i)->dump_binary(w);
+  w.put_type(type);
+}
+
+void let_class::dump_binary(AstWriter& w)
+{
+  w.put_node(AST_LET, this);
+  w.put_id(identifier);
+  w.put_id(type_decl);
+  init->dump_binary(w);
+  body->dump_binary(w);
+  w.put_type(type);
+}
+
+//
+// The arithmetic and comparison nodes only differ in their tag.
+//
+#define DUMP_BINARY_BINOP(cls, tag)             \
+void cls::dump_binary(AstWriter& w)             \
+{                                               \
+  w.put_node(tag, this);                        \
+  e1->dump_binary(w);                           \
+  e2->dump_binary(w);                           \
+  w.put_type(type);                             \
+}
+
+DUMP_BINARY_BINOP(plus_class, AST_PLUS)
+DUMP_BINARY_BINOP(sub_class, AST_SUB)
+DUMP_BINARY_BINOP(mul_class, AST_MUL)
+DUMP_BINARY_BINOP(divide_class, AST_DIVIDE)
+DUMP_BINARY_BINOP(lt_class, AST_LT)
+DUMP_BINARY_BINOP(eq_class, AST_EQ)
+DUMP_BINARY_BINOP(leq_class, AST_LEQ)
+
+void neg_class::dump_binary(AstWriter& w)
+{
+  w.put_node(AST_NEG, this);
+  e1->dump_binary(w);
+  w.put_type(type);
+}
+
+void comp_class::dump_binary(AstWriter& w)
+{
+  w.put_node(AST_COMP, this);
+  e1->dump_binary(w);
+  w.put_type(type);
+}
+
+void isvoid_class::dump_binary(AstWriter& w)
+{
+  w.put_node(AST_ISVOID, this);
+  e1->dump_binary(w);
+  w.put_type(type);
+}
+
+void int_const_class::dump_binary(AstWriter& w)
+{
+  w.put_node(AST_INT_CONST, this);
+  w.put_int(token);
+  w.put_type(type);
+}
+
+void bool_const_class::dump_binary(AstWriter& w)
+{
+  w.put_node(AST_BOOL_CONST, this);
+  w.put_varint(val ? 1 : 0);
+  w.put_type(type);
+}
+
+void string_const_class::dump_binary(AstWriter& w)
+{
+  w.put_node(AST_STRING_CONST, this);
+  w.put_string(token);
+  w.put_type(type);
+}
+
+void new__class::dump_binary(AstWriter& w)
+{
+  w.put_node(AST_NEW, this);
+  w.put_id(type_name);
+  w.put_type(type);
+}
+
+void no_expr_class::dump_binary(AstWriter& w)
+{
+  w.put_node(AST_NO_EXPR, this);
+  w.put_type(type);
+}
+
+void object_class::dump_binary(AstWriter& w)
+{
+  w.put_node(AST_OBJECT, this);
+  w.put_id(name);
+  w.put_type(type);
+}
+
+///////////////////////////////////////////////////////////////////
+//
+// Reader
+//
+///////////////////////////////////////////////////////////////////
+
+class AstReader {
+private:
+  const unsigned char *p;
+  const unsigned char *end;
+  std::vector<Symbol> ids, ints, strs;
+
+  void corrupt()
+  {
+    cerr << "Malformed binary AST" << endl;
+    exit(1);
+  }
+
+  template <class Table>
+  void read_table(Table& table, std::vector<Symbol>& syms)
+  {
+    unsigned int n = varint();
+    syms.reserve(n);
+    for (unsigned int i = 0; i < n; i++) {
+      unsigned int len = varint();
+      if ((size_t) (end - p) < (size_t) len + 1 || p[len] != '\0') corrupt();
+      syms.push_back(table.add_string((char *) p, len));
+      p += len + 1;
+    }
+  }
+
+  Symbol symbol(std::vector<Symbol>& syms)
+  {
+    unsigned int i = varint();
+    if (i >= syms.size()) corrupt();
+    return syms[i];
+  }
+
+  //
+  // Reads the tag and line number of the next node and makes that
+  // line number current for the constructor that follows.
+  //
+  int node()
+  {
+    if (p >= end) corrupt();
+    int tag = *p++;
+    node_lineno = varint();
+    return tag;
+  }
+
+  Expression typed(Expression e)
+  {
+    unsigned int t = varint();
+    if (t > ids.size()) corrupt();
+    if (t) e->set_type(ids[t-1]);
+    return e;
+  }
+
+public:
+  AstReader(const char *buf, size_t size)
+    : p((const unsigned char *) buf), end((const unsigned char *) buf + size) { }
+
+  unsigned int varint()
+  {
+    unsigned int v = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+      if (p >= end) corrupt();
+      unsigned char b = *p++;
+      v |= (unsigned int) (b & 0x7f) << shift;
+      if (!(b & 0x80)) return v;
+    }
+    corrupt();
+    return 0;
+  }
+
+  void read_tables()
+  {
+    read_table(idtable, ids);
+    read_table(inttable, ints);
+    read_table(stringtable, strs);
+  }
+
+  Program read_program();
+  Class_ read_class();
+  Feature read_feature();
+  Formal read_formal();
+  Case read_case();
+  Expression read_expr();
+  Expressions read_exprs();
+
+  bool at_end() { return p == end; }
+};
+
+Program AstReader::read_program()
+{
+  if (node() != AST_PROGRAM) corrupt();
+  int lineno = node_lineno;
+  Classes classes = nil_Classes();
+  for (unsigned int n = varint(); n > 0; n--)
+    classes = append_Classes(classes, single_Classes(read_class()));
+  node_lineno = lineno;
+  return program(classes);
+}
+
+Class_ AstReader::read_class()
+{
+  if (node() != AST_CLASS) corrupt();
+  int lineno = node_lineno;
+  Symbol name = symbol(ids);
+  Symbol parent = symbol(ids);
+  Features features = nil_Features();
+  for (unsigned int n = varint(); n > 0; n--)
+    features = append_Features(features, single_Features(read_feature()));
+  Symbol filename = symbol(strs);
+  node_lineno = lineno;
+  return class_(name, parent, features, filename);
+}
+
+Feature AstReader::read_feature()
+{
+  int tag = node();
+  int lineno = node_lineno;
+  Symbol name = symbol(ids);
+  if (tag == AST_METHOD) {
+    Formals formals = nil_Formals();
+    for (unsigned int n = varint(); n > 0; n--)
+      formals = append_Formals(formals, single_Formals(read_formal()));
+    Symbol return_type = symbol(ids);
+    Expression expr = read_expr();
+    node_lineno = lineno;
+    return method(name, formals, return_type, expr);
+  }
+  if (tag != AST_ATTR) corrupt();
+  Symbol type_decl = symbol(ids);
+  Expression init = read_expr();
+  node_lineno = lineno;
+  return attr(name, type_decl, init);
+}
+
+Formal AstReader::read_formal()
+{
+  if (node() != AST_FORMAL) corrupt();
+  Symbol name = symbol(ids);
+  Symbol type_decl = symbol(ids);
+  return formal(name, type_decl);
+}
+
+Case AstReader::read_case()
+{
+  if (node() != AST_BRANCH) corrupt();
+  int lineno = node_lineno;
+  Symbol name = symbol(ids);
+  Symbol type_decl = symbol(ids);
+  Expression expr = read_expr();
+  node_lineno = lineno;
+  return branch(name, type_decl, expr);
+}
+
+Expressions AstReader::read_exprs()
+{
+  Expressions exprs = nil_Expressions();
+  for (unsigned int n = varint(); n > 0; n--)
+    exprs = append_Expressions(exprs, single_Expressions(read_expr()));
+  return exprs;
+}
+
+//
+// Children are read before the node itself is constructed, so the
+// node's own line number is saved and restored around them.
+//
+Expression AstReader::read_expr()
+{
+  int tag = node();
+  int lineno = node_lineno;
+  Expression e = NULL;
+
+  switch (tag) {
+  case AST_ASSIGN: {
+    Symbol name = symbol(ids);
+    Expression expr = read_expr();
+    node_lineno = lineno;
+    e = assign(name, expr);
+    break;
+  }
+  case AST_STATIC_DISPATCH: {
+    Expression expr = read_expr();
+    Symbol type_name = symbol(ids);
+    Symbol name = symbol(ids);
+    Expressions actual = read_exprs();
+    node_lineno = lineno;
+    e = static_dispatch(expr, type_name, name, actual);
+    break;
+  }
+  case AST_DISPATCH: {
+    Expression expr = read_expr();
+    Symbol name = symbol(ids);
+    Expressions actual = read_exprs();
+    node_lineno = lineno;
+    e = dispatch(expr, name, actual);
+    break;
+  }
+  case AST_COND: {
+    Expression pred = read_expr();
+    Expression then_exp = read_expr();
+    Expression else_exp = read_expr();
+    node_lineno = lineno;
+    e = cond(pred, then_exp, else_exp);
+    break;
+  }
+  case AST_LOOP: {
+    Expression pred = read_expr();
+    Expression body = read_expr();
+    node_lineno = lineno;
+    e = loop(pred, body);
+    break;
+  }
+  case AST_TYPCASE: {
+    Expression expr = read_expr();
+    Cases cases = nil_Cases();
+    for (unsigned int n = varint(); n > 0; n--)
+      cases = append_Cases(cases, single_Cases(read_case()));
+    node_lineno = lineno;
+    e = typcase(expr, cases);
+    break;
+  }
+  case AST_BLOCK: {
+    Expressions body = read_exprs();
+    node_lineno = lineno;
+    e = block(body);
+    break;
+  }
+  case AST_LET: {
+    Symbol identifier = symbol(ids);
+    Symbol type_decl = symbol(ids);
+    Expression init = read_expr();
+    Expression body = read_expr();
+    node_lineno = lineno;
+    e = let(identifier, type_decl, init, body);
+    break;
+  }
+  case AST_PLUS: case AST_SUB: case AST_MUL: case AST_DIVIDE:
+  case AST_LT: case AST_EQ: case AST_LEQ: {
+    Expression e1 = read_expr();
+    Expression e2 = read_expr();
+    node_lineno = lineno;
+    switch (tag) {
+    case AST_PLUS:   e = plus(e1, e2); break;
+    case AST_SUB:    e = sub(e1, e2); break;
+    case AST_MUL:    e = mul(e1, e2); break;
+    case AST_DIVIDE: e = divide(e1, e2); break;
+    case AST_LT:     e = lt(e1, e2); break;
+    case AST_EQ:     e = eq(e1, e2); break;
+    default:         e = leq(e1, e2); break;
+    }
+    break;
+  }
+  case AST_NEG: case AST_COMP: case AST_ISVOID: {
+    Expression e1 = read_expr();
+    node_lineno = lineno;
+    if (tag == AST_NEG)       e = neg(e1);
+    else if (tag == AST_COMP) e = comp(e1);
+    else                      e = isvoid(e1);
+    break;
+  }
+  case AST_INT_CONST:
+    e = int_const(symbol(ints));
+    break;
+  case AST_BOOL_CONST:
+    e = bool_const(varint() != 0);
+    break;
+  case AST_STRING_CONST:
+    e = string_const(symbol(strs));
+    break;
+  case AST_NEW:
+    e = new_(symbol(ids));
+    break;
+  case AST_NO_EXPR:
+    e = no_expr();
+    break;
+  case AST_OBJECT:
+    e = object(symbol(ids));
+    break;
+  default:
+    corrupt();
+  }
+  return typed(e);
+}
+
+Program read_binary(const char *buf, size_t size)
+{
+  if (size < AST_BINARY_HEADER || memcmp(buf, AST_BINARY_MAGIC, 4) != 0) {
+    cerr << "Input is not a binary AST" << endl;
+    exit(1);
+  }
+
+  const unsigned char *h = (const unsigned char *) buf;
+  unsigned int version = h[4] | (h[5] << 8) | (h[6] << 16) | ((unsigned int) h[7] << 24);
+  unsigned int payload = h[8] | (h[9] << 8) | (h[10] << 16) | ((unsigned int) h[11] << 24);
+  if (version != AST_BINARY_VERSION) {
+    cerr << "Unsupported binary AST version " << version << endl;
+    exit(1);
+  }
+  if (payload > size - AST_BINARY_HEADER) {
+    cerr << "Truncated binary AST" << endl;
+    exit(1);
+  }
+
+  AstReader r(buf + AST_BINARY_HEADER, payload);
+  r.read_tables();
+  Program p = r.read_program();
+  if (!r.at_end()) {
+    cerr << "Malformed binary AST" << endl;
+    exit(1);
+  }
+  return p;
+}
+
+//
+// Regular files are mapped and read in place; pipes are slurped into
+// memory first.
+//
+Program read_binary(FILE *f)
+{
+  struct stat st;
+  int fd = fileno(f);
+
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map != MAP_FAILED) {
+      Program p = read_binary((const char *) map, st.st_size);
+      munmap(map, st.st_size);
+      return p;
+    }
+  }
+
+  std::string buf;
+  char chunk[65536];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0)
+    buf.append(chunk, n);
+  return read_binary(buf.data(), buf.size());
+}
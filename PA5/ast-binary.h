@@ -0,0 +1,89 @@
+#ifndef AST_BINARY_H
+#define AST_BINARY_H
+//////////////////////////////////////////////////////////////////////
+//
+//  ast-binary.h
+//
+//  A compact binary form of the Cool AST for handing a program from
+//  one compiler phase to another, in place of the dump_with_types text
+//  that ast-lex.cc/ast-parse.cc have to re-parse.
+//
+//  Layout (all multi-byte header fields little endian):
+//
+//     "CAST"             magic
+//     u32 version        AST_BINARY_VERSION
+//     u32 size           number of payload bytes that follow
+//     payload:
+//        id table        varint count, then count entries
+//        int table       (same)
+//        string table    (same)
+//        program node
+//
+//  A table entry is a varint length followed by the characters and a
+//  terminating NUL.  Symbols in the node stream are varint indices into
+//  the table of this file that matches the field (names and types into
+//  the id table, int_const tokens into the int table, string_const
+//  tokens and file names into the string table), so the numbering is
+//  local to the file and independent of the writer's Entry indices.
+//
+//  Every node starts with its AstTag and a varint line number, followed
+//  by its fields in cool-tree.aps order.  Lists are a varint count
+//  followed by the elements.  An Expression's type is written after its
+//  fields as a varint id index plus one, 0 meaning no type.
+//
+//  The whole image is size-prefixed and position independent, so the
+//  reader can work directly on an mmap of the file.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "cool-tree.h"
+
+#define AST_BINARY_MAGIC   "CAST"
+#define AST_BINARY_VERSION 1
+#define AST_BINARY_HEADER  12
+
+// the tags are the AstTags of cool-tree.handcode.h
+
+//
+// AstWriter collects the node stream in memory while numbering the
+// symbols it meets; finish() then emits header, tables and nodes.
+// The dump_binary methods of the tree nodes drive it.
+//
+class AstWriter {
+private:
+    std::string m_nodes;
+    std::unordered_map<Symbol, int> m_index[3];
+    std::vector<Symbol> m_symbols[3];
+
+    int symbol_index(int table, Symbol sym);
+    void put_symbol(int table, Symbol sym);
+    void put_table(std::string& out, int table);
+
+public:
+    enum { ID_TABLE, INT_TABLE, STR_TABLE };
+
+    void put_varint(unsigned int v);
+    void put_node(AstTag tag, tree_node *t);
+    void put_id(Symbol sym)     { put_symbol(ID_TABLE, sym); }
+    void put_int(Symbol sym)    { put_symbol(INT_TABLE, sym); }
+    void put_string(Symbol sym) { put_symbol(STR_TABLE, sym); }
+    void put_type(Symbol sym);
+
+    void finish(ostream& s);
+};
+
+void dump_binary(ostream& s, Program p);
+
+//
+// Rebuild a Program from a binary image.  The symbols of the image are
+// interned into idtable/inttable/stringtable before any node is built.
+// Both functions report malformed input and exit.
+//
+Program read_binary(const char *buf, size_t size);
+Program read_binary(FILE *f);
+
+#endif
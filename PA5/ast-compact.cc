@@ -0,0 +1,505 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////
+//
+//  ast-compact.cc
+//
+//  Conversion between the tree_node AST and the CompactAst of
+//  ast-compact.h.
+//
+//  tree -> compact is a recursive traversal like dump_binary in
+//  ast-binary.cc: every kind of node has a to_compact method that adds
+//  its children, then itself, and returns its AstRef.
+//
+//  compact -> tree walks the pools from the root and rebuilds the
+//  nodes through the ordinary constructors after setting node_lineno,
+//  as the AST readers do.
+//
+//////////////////////////////////////////////////////////////////
+
+#include <stdlib.h>
+#include "cool-io.h"
+#include "ast-compact.h"
+
+extern int node_lineno;
+
+///////////////////////////////////////////////////////////////////
+//
+// CompactAst
+//
+///////////////////////////////////////////////////////////////////
+
+template <class Node>
+void CompactAst::add_kind(AstTag kind, AstPool<Node>& pool, bool expr)
+{
+  m_lines[kind] = &pool.lines;
+  m_types[kind] = expr ? &pool.types : NULL;
+}
+
+CompactAst::CompactAst()
+{
+  for (int k = 0; k < AST_KINDS; k++) {
+    m_lines[k] = NULL;
+    m_types[k] = NULL;
+  }
+  add_kind(AST_PROGRAM, program, false);
+  add_kind(AST_CLASS, class_, false);
+  add_kind(AST_METHOD, method, false);
+  add_kind(AST_ATTR, attr, false);
+  add_kind(AST_FORMAL, formal, false);
+  add_kind(AST_BRANCH, branch, false);
+  add_kind(AST_ASSIGN, assign, true);
+  add_kind(AST_STATIC_DISPATCH, static_dispatch, true);
+  add_kind(AST_DISPATCH, dispatch, true);
+  add_kind(AST_COND, cond, true);
+  add_kind(AST_LOOP, loop, true);
+  add_kind(AST_TYPCASE, typcase, true);
+  add_kind(AST_BLOCK, block, true);
+  add_kind(AST_LET, let, true);
+  add_kind(AST_PLUS, plus, true);
+  add_kind(AST_SUB, sub, true);
+  add_kind(AST_MUL, mul, true);
+  add_kind(AST_DIVIDE, divide, true);
+  add_kind(AST_NEG, neg, true);
+  add_kind(AST_LT, lt, true);
+  add_kind(AST_EQ, eq, true);
+  add_kind(AST_LEQ, leq, true);
+  add_kind(AST_COMP, comp, true);
+  add_kind(AST_INT_CONST, int_const, true);
+  add_kind(AST_BOOL_CONST, bool_const, true);
+  add_kind(AST_STRING_CONST, string_const, true);
+  add_kind(AST_NEW, new_, true);
+  add_kind(AST_ISVOID, isvoid, true);
+  add_kind(AST_NO_EXPR, no_expr, true);
+  add_kind(AST_OBJECT, object, true);
+
+  symbols.push_back((Symbol) NULL);
+  m_index[(Symbol) NULL] = 0;
+}
+
+AstSym CompactAst::sym(Symbol s)
+{
+  std::unordered_map<Symbol, AstSym>::iterator it = m_index.find(s);
+  if (it == m_index.end()) {
+    it = m_index.insert(std::make_pair(s, (AstSym) symbols.size())).first;
+    symbols.push_back(s);
+  }
+  return it->second;
+}
+
+AstList CompactAst::list(const std::vector<AstRef>& elems)
+{
+  AstList l;
+  l.first = lists.size();
+  l.count = elems.size();
+  lists.insert(lists.end(), elems.begin(), elems.end());
+  return l;
+}
+
+AstRef to_compact(CompactAst& c, Program p)
+{
+  return p->to_compact(c);
+}
+
+///////////////////////////////////////////////////////////////////
+//
+// to_compact for every kind of node
+//
+///////////////////////////////////////////////////////////////////
+
+//
+// The AstList of a tree list, its elements converted first.
+//
+template <class Elem>
+static AstList compact_list(CompactAst& c, list_node<Elem> *l)
+{
+  std::vector<AstRef> elems;
+  elems.reserve(l->len());
+  for (int i = l->first(); l->more(i); i = l->next(i))
+    elems.push_back(l->nth(i)->to_compact(c));
+  return c.list(elems);
+}
+
+AstRef program_class::to_compact(CompactAst& c)
+{
+  AstProgramNode n;
+  n.classes = compact_list(c, classes);
+  return c.add(AST_PROGRAM, c.program, n, this);
+}
+
+AstRef class__class::to_compact(CompactAst& c)
+{
+  AstClassNode n;
+  n.name = c.sym(name);
+  n.parent = c.sym(parent);
+  n.features = compact_list(c, features);
+  n.filename = c.sym(filename);
+  return c.add(AST_CLASS, c.class_, n, this);
+}
+
+AstRef method_class::to_compact(CompactAst& c)
+{
+  AstMethodNode n;
+  n.name = c.sym(name);
+  n.formals = compact_list(c, formals);
+  n.return_type = c.sym(return_type);
+  n.expr = expr->to_compact(c);
+  return c.add(AST_METHOD, c.method, n, this);
+}
+
+AstRef attr_class::to_compact(CompactAst& c)
+{
+  AstAttrNode n;
+  n.name = c.sym(name);
+  n.type_decl = c.sym(type_decl);
+  n.init = init->to_compact(c);
+  return c.add(AST_ATTR, c.attr, n, this);
+}
+
+AstRef formal_class::to_compact(CompactAst& c)
+{
+  AstFormalNode n;
+  n.name = c.sym(name);
+  n.type_decl = c.sym(type_decl);
+  return c.add(AST_FORMAL, c.formal, n, this);
+}
+
+AstRef branch_class::to_compact(CompactAst& c)
+{
+  AstBranchNode n;
+  n.name = c.sym(name);
+  n.type_decl = c.sym(type_decl);
+  n.expr = expr->to_compact(c);
+  return c.add(AST_BRANCH, c.branch, n, this);
+}
+
+AstRef assign_class::to_compact(CompactAst& c)
+{
+  AstAssignNode n;
+  n.name = c.sym(name);
+  n.expr = expr->to_compact(c);
+  return c.add_expr(AST_ASSIGN, c.assign, n, this);
+}
+
+AstRef static_dispatch_class::to_compact(CompactAst& c)
+{
+  AstDispatchNode n;
+  n.expr = expr->to_compact(c);
+  n.type_name = c.sym(type_name);
+  n.name = c.sym(name);
+  n.actual = compact_list(c, actual);
+  return c.add_expr(AST_STATIC_DISPATCH, c.static_dispatch, n, this);
+}
+
+AstRef dispatch_class::to_compact(CompactAst& c)
+{
+  AstDispatchNode n;
+  n.expr = expr->to_compact(c);
+  n.type_name = 0;
+  n.name = c.sym(name);
+  n.actual = compact_list(c, actual);
+  return c.add_expr(AST_DISPATCH, c.dispatch, n, this);
+}
+
+AstRef cond_class::to_compact(CompactAst& c)
+{
+  AstCondNode n;
+  n.pred = pred->to_compact(c);
+  n.then_exp = then_exp->to_compact(c);
+  n.else_exp = else_exp->to_compact(c);
+  return c.add_expr(AST_COND, c.cond, n, this);
+}
+
+AstRef loop_class::to_compact(CompactAst& c)
+{
+  AstLoopNode n;
+  n.pred = pred->to_compact(c);
+  n.body = body->to_compact(c);
+  return c.add_expr(AST_LOOP, c.loop, n, this);
+}
+
+AstRef typcase_class::to_compact(CompactAst& c)
+{
+  AstTypcaseNode n;
+  n.expr = expr->to_compact(c);
+  n.cases = compact_list(c, cases);
+  return c.add_expr(AST_TYPCASE, c.typcase, n, this);
+}
+
+AstRef block_class::to_compact(CompactAst& c)
+{
+  AstBlockNode n;
+  n.body = compact_list(c, body);
+  return c.add_expr(AST_BLOCK, c.block, n, this);
+}
+
+AstRef let_class::to_compact(CompactAst& c)
+{
+  AstLetNode n;
+  n.identifier = c.sym(identifier);
+  n.type_decl = c.sym(type_decl);
+  n.init = init->to_compact(c);
+  n.body = body->to_compact(c);
+  return c.add_expr(AST_LET, c.let, n, this);
+}
+
+//
+// The arithmetic and comparison nodes only differ in their kind.
+//
+#define TO_COMPACT_BINOP(cls, tag, pool)        \
+AstRef cls::to_compact(CompactAst& c)           \
+{                                               \
+  AstBinaryNode n;                              \
+  n.e1 = e1->to_compact(c);                     \
+  n.e2 = e2->to_compact(c);                     \
+  return c.add_expr(tag, c.pool, n, this);      \
+}
+
+TO_COMPACT_BINOP(plus_class, AST_PLUS, plus)
+TO_COMPACT_BINOP(sub_class, AST_SUB, sub)
+TO_COMPACT_BINOP(mul_class, AST_MUL, mul)
+TO_COMPACT_BINOP(divide_class, AST_DIVIDE, divide)
+TO_COMPACT_BINOP(lt_class, AST_LT, lt)
+TO_COMPACT_BINOP(eq_class, AST_EQ, eq)
+TO_COMPACT_BINOP(leq_class, AST_LEQ, leq)
+
+#define TO_COMPACT_UNOP(cls, tag, pool)         \
+AstRef cls::to_compact(CompactAst& c)           \
+{                                               \
+  AstUnaryNode n;                               \
+  n.e1 = e1->to_compact(c);                     \
+  return c.add_expr(tag, c.pool, n, this);      \
+}
+
+TO_COMPACT_UNOP(neg_class, AST_NEG, neg)
+TO_COMPACT_UNOP(comp_class, AST_COMP, comp)
+TO_COMPACT_UNOP(isvoid_class, AST_ISVOID, isvoid)
+
+#define TO_COMPACT_SYMBOL(cls, tag, pool, field) \
+AstRef cls::to_compact(CompactAst& c)           \
+{                                               \
+  AstSymbolNode n;                              \
+  n.sym = c.sym(field);                         \
+  return c.add_expr(tag, c.pool, n, this);      \
+}
+
+TO_COMPACT_SYMBOL(int_const_class, AST_INT_CONST, int_const, token)
+TO_COMPACT_SYMBOL(string_const_class, AST_STRING_CONST, string_const, token)
+TO_COMPACT_SYMBOL(new__class, AST_NEW, new_, type_name)
+TO_COMPACT_SYMBOL(object_class, AST_OBJECT, object, name)
+
+AstRef bool_const_class::to_compact(CompactAst& c)
+{
+  AstBoolNode n;
+  n.val = val ? true : false;
+  return c.add_expr(AST_BOOL_CONST, c.bool_const, n, this);
+}
+
+AstRef no_expr_class::to_compact(CompactAst& c)
+{
+  AstEmptyNode n;
+  return c.add_expr(AST_NO_EXPR, c.no_expr, n, this);
+}
+
+///////////////////////////////////////////////////////////////////
+//
+// to_tree
+//
+// Children are built before the node itself, so the node's line
+// number is set last, right before its constructor.
+//
+///////////////////////////////////////////////////////////////////
+
+Program CompactAst::to_tree(AstRef r)
+{
+  AstProgramNode& p = program.nodes[index(r)];
+  Classes classes = nil_Classes();
+
+  for (unsigned int i = 0; i < p.classes.count; i++) {
+    AstRef cr = elem(p.classes, i);
+    AstClassNode& cn = class_.nodes[index(cr)];
+    Features features = nil_Features();
+
+    for (unsigned int j = 0; j < cn.features.count; j++) {
+      AstRef fr = elem(cn.features, j);
+      Feature f;
+      if (kind(fr) == AST_METHOD) {
+        AstMethodNode& m = method.nodes[index(fr)];
+        Formals formals = nil_Formals();
+        for (unsigned int k = 0; k < m.formals.count; k++) {
+          AstRef fo = elem(m.formals, k);
+          AstFormalNode& fn = formal.nodes[index(fo)];
+          node_lineno = line(fo);
+          formals = append_Formals(formals,
+              single_Formals(::formal(symbol(fn.name), symbol(fn.type_decl))));
+        }
+        Expression body = expr_to_tree(m.expr);
+        node_lineno = line(fr);
+        f = ::method(symbol(m.name), formals, symbol(m.return_type), body);
+      } else {
+        AstAttrNode& a = attr.nodes[index(fr)];
+        Expression init = expr_to_tree(a.init);
+        node_lineno = line(fr);
+        f = ::attr(symbol(a.name), symbol(a.type_decl), init);
+      }
+      features = append_Features(features, single_Features(f));
+    }
+
+    node_lineno = line(cr);
+    classes = append_Classes(classes, single_Classes(
+        ::class_(symbol(cn.name), symbol(cn.parent), features, symbol(cn.filename))));
+  }
+
+  node_lineno = line(r);
+  return ::program(classes);
+}
+
+Expression CompactAst::expr_to_tree(AstRef r)
+{
+  unsigned int i = index(r);
+  Expression e = NULL;
+
+  switch (kind(r)) {
+  case AST_ASSIGN: {
+    AstAssignNode& n = assign.nodes[i];
+    Expression expr = expr_to_tree(n.expr);
+    node_lineno = line(r);
+    e = ::assign(symbol(n.name), expr);
+    break;
+  }
+  case AST_STATIC_DISPATCH:
+  case AST_DISPATCH: {
+    AstDispatchNode& n = kind(r) == AST_DISPATCH ? dispatch.nodes[i]
+                                                 : static_dispatch.nodes[i];
+    Expression expr = expr_to_tree(n.expr);
+    Expressions actual = nil_Expressions();
+    for (unsigned int k = 0; k < n.actual.count; k++)
+      actual = append_Expressions(actual, single_Expressions(expr_to_tree(elem(n.actual, k))));
+    node_lineno = line(r);
+    if (kind(r) == AST_DISPATCH)
+      e = ::dispatch(expr, symbol(n.name), actual);
+    else
+      e = ::static_dispatch(expr, symbol(n.type_name), symbol(n.name), actual);
+    break;
+  }
+  case AST_COND: {
+    AstCondNode& n = cond.nodes[i];
+    Expression pred = expr_to_tree(n.pred);
+    Expression then_exp = expr_to_tree(n.then_exp);
+    Expression else_exp = expr_to_tree(n.else_exp);
+    node_lineno = line(r);
+    e = ::cond(pred, then_exp, else_exp);
+    break;
+  }
+  case AST_LOOP: {
+    AstLoopNode& n = loop.nodes[i];
+    Expression pred = expr_to_tree(n.pred);
+    Expression body = expr_to_tree(n.body);
+    node_lineno = line(r);
+    e = ::loop(pred, body);
+    break;
+  }
+  case AST_TYPCASE: {
+    AstTypcaseNode& n = typcase.nodes[i];
+    Expression expr = expr_to_tree(n.expr);
+    Cases cases = nil_Cases();
+    for (unsigned int k = 0; k < n.cases.count; k++) {
+      AstRef br = elem(n.cases, k);
+      AstBranchNode& b = branch.nodes[index(br)];
+      Expression body = expr_to_tree(b.expr);
+      node_lineno = line(br);
+      cases = append_Cases(cases, single_Cases(
+          ::branch(symbol(b.name), symbol(b.type_decl), body)));
+    }
+    node_lineno = line(r);
+    e = ::typcase(expr, cases);
+    break;
+  }
+  case AST_BLOCK: {
+    AstBlockNode& n = block.nodes[i];
+    Expressions body = nil_Expressions();
+    for (unsigned int k = 0; k < n.body.count; k++)
+      body = append_Expressions(body, single_Expressions(expr_to_tree(elem(n.body, k))));
+    node_lineno = line(r);
+    e = ::block(body);
+    break;
+  }
+  case AST_LET: {
+    AstLetNode& n = let.nodes[i];
+    Expression init = expr_to_tree(n.init);
+    Expression body = expr_to_tree(n.body);
+    node_lineno = line(r);
+    e = ::let(symbol(n.identifier), symbol(n.type_decl), init, body);
+    break;
+  }
+  case AST_PLUS: case AST_SUB: case AST_MUL: case AST_DIVIDE:
+  case AST_LT: case AST_EQ: case AST_LEQ: {
+    AstBinaryNode n;
+    switch (kind(r)) {
+    case AST_PLUS:   n = plus.nodes[i]; break;
+    case AST_SUB:    n = sub.nodes[i]; break;
+    case AST_MUL:    n = mul.nodes[i]; break;
+    case AST_DIVIDE: n = divide.nodes[i]; break;
+    case AST_LT:     n = lt.nodes[i]; break;
+    case AST_EQ:     n = eq.nodes[i]; break;
+    default:         n = leq.nodes[i]; break;
+    }
+    Expression e1 = expr_to_tree(n.e1);
+    Expression e2 = expr_to_tree(n.e2);
+    node_lineno = line(r);
+    switch (kind(r)) {
+    case AST_PLUS:   e = ::plus(e1, e2); break;
+    case AST_SUB:    e = ::sub(e1, e2); break;
+    case AST_MUL:    e = ::mul(e1, e2); break;
+    case AST_DIVIDE: e = ::divide(e1, e2); break;
+    case AST_LT:     e = ::lt(e1, e2); break;
+    case AST_EQ:     e = ::eq(e1, e2); break;
+    default:         e = ::leq(e1, e2); break;
+    }
+    break;
+  }
+  case AST_NEG: case AST_COMP: case AST_ISVOID: {
+    AstUnaryNode n = kind(r) == AST_NEG  ? neg.nodes[i]
+                   : kind(r) == AST_COMP ? comp.nodes[i]
+                   :                       isvoid.nodes[i];
+    Expression e1 = expr_to_tree(n.e1);
+    node_lineno = line(r);
+    if (kind(r) == AST_NEG)       e = ::neg(e1);
+    else if (kind(r) == AST_COMP) e = ::comp(e1);
+    else                          e = ::isvoid(e1);
+    break;
+  }
+  case AST_INT_CONST:
+    node_lineno = line(r);
+    e = ::int_const(symbol(int_const.nodes[i].sym));
+    break;
+  case AST_BOOL_CONST:
+    node_lineno = line(r);
+    e = ::bool_const(bool_const.nodes[i].val);
+    break;
+  case AST_STRING_CONST:
+    node_lineno = line(r);
+    e = ::string_const(symbol(string_const.nodes[i].sym));
+    break;
+  case AST_NEW:
+    node_lineno = line(r);
+    e = ::new_(symbol(new_.nodes[i].sym));
+    break;
+  case AST_NO_EXPR:
+    node_lineno = line(r);
+    e = ::no_expr();
+    break;
+  case AST_OBJECT:
+    node_lineno = line(r);
+    e = ::object(symbol(object.nodes[i].sym));
+    break;
+  default:
+    cerr << "not an expression in compact AST" << endl;
+    exit(1);
+  }
+  return e->set_type(type(r));
+}
@@ -0,0 +1,179 @@
+#ifndef AST_COMPACT_H
+#define AST_COMPACT_H
+//////////////////////////////////////////////////////////////////////
+//
+//  ast-compact.h
+//
+//  A data oriented form of the Cool AST, kept next to the tree_node
+//  classes of cool-tree.h while passes move over to it.
+//
+//  Every kind of node (the AstTag of ast-binary.h) has its own pool:
+//  an array of small structs holding only the node's fields, plus two
+//  parallel arrays with the line numbers and, for expressions, the
+//  types.  Nodes refer to each other by 32-bit AstRefs instead of
+//  pointers, symbols are 32-bit indices into the symbol table of the
+//  CompactAst, and the elements of all lists sit back to back in one
+//  array, a list being a (first, count) range of it.  There are no
+//  vtables, no per-node headers and no padding for 8-byte pointers, so
+//  a node takes a third to a half of the memory of its tree_node, and
+//  the nodes of one kind are contiguous.
+//
+//  An AstRef is the kind of the node in the top AST_KIND_BITS bits and
+//  its index in that kind's pool below them.  AstTags start at 1, so
+//  the AstRef 0 never names a node.  AstSym 0 is the NULL symbol (an
+//  expression that has no type yet).
+//
+//  to_compact (a method of every tree node, like dump_binary) converts
+//  a tree, and to_tree converts back through the ordinary constructors,
+//  so that passes still written against tree_node -- tc(), code() --
+//  keep working on either form.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <stdlib.h>
+#include <vector>
+#include <unordered_map>
+#include "cool-tree.h"
+#include "ast-binary.h"
+
+#define AST_KIND_BITS  5
+#define AST_INDEX_BITS (32 - AST_KIND_BITS)
+#define AST_KINDS      (AST_OBJECT + 1)
+
+typedef unsigned int AstSym;
+
+struct AstList {
+    unsigned int first;         // position in CompactAst::lists
+    unsigned int count;
+};
+
+//
+// The fields of each kind of node, in cool-tree.aps order.  Kinds with
+// the same fields share a struct but still have pools of their own.
+//
+struct AstProgramNode   { AstList classes; };
+struct AstClassNode     { AstSym name, parent; AstList features; AstSym filename; };
+struct AstMethodNode    { AstSym name; AstList formals; AstSym return_type; AstRef expr; };
+struct AstAttrNode      { AstSym name, type_decl; AstRef init; };
+struct AstFormalNode    { AstSym name, type_decl; };
+struct AstBranchNode    { AstSym name, type_decl; AstRef expr; };
+struct AstAssignNode    { AstSym name; AstRef expr; };
+// type_name is 0 for a dispatch
+struct AstDispatchNode  { AstRef expr; AstSym type_name, name; AstList actual; };
+struct AstCondNode      { AstRef pred, then_exp, else_exp; };
+struct AstLoopNode      { AstRef pred, body; };
+struct AstTypcaseNode   { AstRef expr; AstList cases; };
+struct AstBlockNode     { AstList body; };
+struct AstLetNode       { AstSym identifier, type_decl; AstRef init, body; };
+struct AstBinaryNode    { AstRef e1, e2; };
+struct AstUnaryNode     { AstRef e1; };
+// the token of a constant, the type of a new_, the name of an object
+struct AstSymbolNode    { AstSym sym; };
+struct AstBoolNode      { bool val; };
+struct AstEmptyNode     { };
+
+template <class Node>
+struct AstPool {
+    std::vector<Node> nodes;
+    std::vector<int> lines;     // line number of nodes[i]
+    std::vector<AstSym> types;  // type of nodes[i]; empty if not expressions
+};
+
+class CompactAst {
+private:
+    std::unordered_map<Symbol, AstSym> m_index;
+    std::vector<int> *m_lines[AST_KINDS];
+    std::vector<AstSym> *m_types[AST_KINDS];
+
+    template <class Node>
+    void add_kind(AstTag kind, AstPool<Node>& pool, bool expr);
+
+    Expression expr_to_tree(AstRef r);
+
+public:
+    std::vector<Symbol> symbols;
+    std::vector<AstRef> lists;
+
+    AstPool<AstProgramNode>  program;
+    AstPool<AstClassNode>    class_;
+    AstPool<AstMethodNode>   method;
+    AstPool<AstAttrNode>     attr;
+    AstPool<AstFormalNode>   formal;
+    AstPool<AstBranchNode>   branch;
+    AstPool<AstAssignNode>   assign;
+    AstPool<AstDispatchNode> static_dispatch;
+    AstPool<AstDispatchNode> dispatch;
+    AstPool<AstCondNode>     cond;
+    AstPool<AstLoopNode>     loop;
+    AstPool<AstTypcaseNode>  typcase;
+    AstPool<AstBlockNode>    block;
+    AstPool<AstLetNode>      let;
+    AstPool<AstBinaryNode>   plus, sub, mul, divide, lt, eq, leq;
+    AstPool<AstUnaryNode>    neg, comp, isvoid;
+    AstPool<AstSymbolNode>   int_const, string_const, new_, object;
+    AstPool<AstBoolNode>     bool_const;
+    AstPool<AstEmptyNode>    no_expr;
+
+    CompactAst();
+
+    static AstTag kind(AstRef r)        { return (AstTag) (r >> AST_INDEX_BITS); }
+    static unsigned int index(AstRef r) { return r & ((1u << AST_INDEX_BITS) - 1); }
+    static AstRef ref(AstTag kind, unsigned int i)
+                                        { return ((AstRef) kind << AST_INDEX_BITS) | i; }
+
+    int line(AstRef r)                  { return (*m_lines[kind(r)])[index(r)]; }
+    Symbol type(AstRef r)               { return symbols[(*m_types[kind(r)])[index(r)]]; }
+    void set_type(AstRef r, Symbol t)   { (*m_types[kind(r)])[index(r)] = sym(t); }
+
+    Symbol symbol(AstSym s)             { return symbols[s]; }
+    AstRef elem(AstList l, unsigned int i) { return lists[l.first + i]; }
+
+    //
+    // Building.  A node's children are added before the node, and the
+    // elements of a list are collected first and then added in one go
+    // so that they are contiguous.
+    //
+    AstSym sym(Symbol s);
+    AstList list(const std::vector<AstRef>& elems);
+    template <class Node>
+    AstRef add(AstTag kind, AstPool<Node>& pool, const Node& n, tree_node *t);
+    template <class Node>
+    AstRef add_expr(AstTag kind, AstPool<Node>& pool, const Node& n, Expression_class *e);
+
+    // The tree rooted at r, which must be an AST_PROGRAM.
+    Program to_tree(AstRef r);
+};
+
+//
+// Convert the tree p into c and return the AstRef of its root.
+//
+AstRef to_compact(CompactAst& c, Program p);
+
+//////////////////////////////////////////////////////////////////////
+//
+//  Templates
+//
+//////////////////////////////////////////////////////////////////////
+
+template <class Node>
+AstRef CompactAst::add(AstTag kind, AstPool<Node>& pool, const Node& n, tree_node *t)
+{
+    unsigned int i = pool.nodes.size();
+    if (i >> AST_INDEX_BITS) {
+        cerr << "too many nodes of one kind for a compact AST" << endl;
+        exit(1);
+    }
+    pool.nodes.push_back(n);
+    pool.lines.push_back(t->get_line_number());
+    return ref(kind, i);
+}
+
+template <class Node>
+AstRef CompactAst::add_expr(AstTag kind, AstPool<Node>& pool, const Node& n, Expression_class *e)
+{
+    AstRef r = add(kind, pool, n, e);
+    pool.types.push_back(sym(e->get_type()));
+    return r;
+}
+
+#endif
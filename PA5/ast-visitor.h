@@ -0,0 +1,171 @@
+#ifndef AST_VISITOR_H
+#define AST_VISITOR_H
+//////////////////////////////////////////////////////////////////////
+//
+//  ast-visitor.h
+//
+//  Traversals of the AST that do not need a virtual method in every
+//  node class.  A pass derives from AstVisitor<itself> (CRTP) and
+//  defines enter/leave hooks for the node classes it cares about:
+//
+//     class CountPlus : public AstVisitor<CountPlus> {
+//     public:
+//        using AstVisitor<CountPlus>::enter;   // defaults for the rest
+//        int n;
+//        CountPlus() : n(0) { }
+//        void enter(plus_class *) { n++; }
+//     };
+//
+//     CountPlus c;
+//     c.visit(ast_root);
+//
+//  visit() walks the tree depth first, calling enter(node) before the
+//  children of a node and leave(node) after them, children in
+//  cool-tree.aps order.  The one virtual call per node is kind(); the
+//  hooks are resolved by overloading on the node class at compile time
+//  and inlined, so a node class without hooks costs nothing but the
+//  walk over its children.
+//
+//  A pass that needs a different order for some kind of node (say,
+//  the init of a let before entering the scope of its variable) can
+//  define walk(let_class *) as well, with `using' for the default
+//  walk, and call visit() on the children itself.
+//
+//  fuse(a, b) makes one visitor out of two: the single traversal calls
+//  a's hooks and then b's on every node, so two passes over the tree
+//  cost one walk over its memory.  A fused visitor can be fused again
+//  once it has a name: auto ab = fuse(a, b); fuse(ab, c).visit(p).
+//  Only the enter/leave hooks of a and b are used, not their walks.
+//  Nothing fuses passes yet: CalledNames in coolc-phase.cc is the only
+//  pass written as a visitor so far, and semant and cgen still use
+//  their virtual methods.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "cool-tree.h"
+
+template <class Derived>
+class AstVisitor {
+protected:
+    Derived& self() { return *static_cast<Derived *>(this); }
+
+    template <class Elem>
+    void visit_list(list_node<Elem> *l)
+    {
+        for (int i = l->first(); l->more(i); i = l->next(i))
+            visit(l->nth(i));
+    }
+
+public:
+    // The default hooks do nothing.
+    template <class Node> void enter(Node *) { }
+    template <class Node> void leave(Node *) { }
+
+    template <class Node>
+    void walk(Node *n)
+    {
+        self().enter(n);
+        children(n);
+        self().leave(n);
+    }
+
+    //
+    // visit() finds the class of a node from its kind() and walks it.
+    //
+    void visit(Program p)   { self().walk(static_cast<program_class *>(p)); }
+    void visit(Class_ c)    { self().walk(static_cast<class__class *>(c)); }
+    void visit(Formal f)    { self().walk(static_cast<formal_class *>(f)); }
+    void visit(Case c)      { self().walk(static_cast<branch_class *>(c)); }
+
+    void visit(Feature f)
+    {
+        if (f->kind() == AST_METHOD)
+            self().walk(static_cast<method_class *>(f));
+        else
+            self().walk(static_cast<attr_class *>(f));
+    }
+
+    void visit(Expression e)
+    {
+        switch (e->kind()) {
+        case AST_ASSIGN:          self().walk(static_cast<assign_class *>(e)); break;
+        case AST_STATIC_DISPATCH: self().walk(static_cast<static_dispatch_class *>(e)); break;
+        case AST_DISPATCH:        self().walk(static_cast<dispatch_class *>(e)); break;
+        case AST_COND:            self().walk(static_cast<cond_class *>(e)); break;
+        case AST_LOOP:            self().walk(static_cast<loop_class *>(e)); break;
+        case AST_TYPCASE:         self().walk(static_cast<typcase_class *>(e)); break;
+        case AST_BLOCK:           self().walk(static_cast<block_class *>(e)); break;
+        case AST_LET:             self().walk(static_cast<let_class *>(e)); break;
+        case AST_PLUS:            self().walk(static_cast<plus_class *>(e)); break;
+        case AST_SUB:             self().walk(static_cast<sub_class *>(e)); break;
+        case AST_MUL:             self().walk(static_cast<mul_class *>(e)); break;
+        case AST_DIVIDE:          self().walk(static_cast<divide_class *>(e)); break;
+        case AST_NEG:             self().walk(static_cast<neg_class *>(e)); break;
+        case AST_LT:              self().walk(static_cast<lt_class *>(e)); break;
+        case AST_EQ:              self().walk(static_cast<eq_class *>(e)); break;
+        case AST_LEQ:             self().walk(static_cast<leq_class *>(e)); break;
+        case AST_COMP:            self().walk(static_cast<comp_class *>(e)); break;
+        case AST_INT_CONST:       self().walk(static_cast<int_const_class *>(e)); break;
+        case AST_BOOL_CONST:      self().walk(static_cast<bool_const_class *>(e)); break;
+        case AST_STRING_CONST:    self().walk(static_cast<string_const_class *>(e)); break;
+        case AST_NEW:             self().walk(static_cast<new__class *>(e)); break;
+        case AST_ISVOID:          self().walk(static_cast<isvoid_class *>(e)); break;
+        case AST_NO_EXPR:         self().walk(static_cast<no_expr_class *>(e)); break;
+        default:                  self().walk(static_cast<object_class *>(e)); break;
+        }
+    }
+
+    //
+    // The children of each kind of node.
+    //
+    void children(program_class *n)         { visit_list(n->classes); }
+    void children(class__class *n)          { visit_list(n->features); }
+    void children(method_class *n)          { visit_list(n->formals); visit(n->expr); }
+    void children(attr_class *n)            { visit(n->init); }
+    void children(formal_class *)           { }
+    void children(branch_class *n)          { visit(n->expr); }
+    void children(assign_class *n)          { visit(n->expr); }
+    void children(static_dispatch_class *n) { visit(n->expr); visit_list(n->actual); }
+    void children(dispatch_class *n)        { visit(n->expr); visit_list(n->actual); }
+    void children(cond_class *n)            { visit(n->pred); visit(n->then_exp); visit(n->else_exp); }
+    void children(loop_class *n)            { visit(n->pred); visit(n->body); }
+    void children(typcase_class *n)         { visit(n->expr); visit_list(n->cases); }
+    void children(block_class *n)           { visit_list(n->body); }
+    void children(let_class *n)             { visit(n->init); visit(n->body); }
+    void children(plus_class *n)            { visit(n->e1); visit(n->e2); }
+    void children(sub_class *n)             { visit(n->e1); visit(n->e2); }
+    void children(mul_class *n)             { visit(n->e1); visit(n->e2); }
+    void children(divide_class *n)          { visit(n->e1); visit(n->e2); }
+    void children(neg_class *n)             { visit(n->e1); }
+    void children(lt_class *n)              { visit(n->e1); visit(n->e2); }
+    void children(eq_class *n)              { visit(n->e1); visit(n->e2); }
+    void children(leq_class *n)             { visit(n->e1); visit(n->e2); }
+    void children(comp_class *n)            { visit(n->e1); }
+    void children(int_const_class *)        { }
+    void children(bool_const_class *)       { }
+    void children(string_const_class *)     { }
+    void children(new__class *)             { }
+    void children(isvoid_class *n)          { visit(n->e1); }
+    void children(no_expr_class *)          { }
+    void children(object_class *)           { }
+};
+
+template <class A, class B>
+class FusedVisitor : public AstVisitor<FusedVisitor<A, B> > {
+private:
+    A& m_a;
+    B& m_b;
+public:
+    FusedVisitor(A& a, B& b) : m_a(a), m_b(b) { }
+
+    template <class Node> void enter(Node *n) { m_a.enter(n); m_b.enter(n); }
+    template <class Node> void leave(Node *n) { m_a.leave(n); m_b.leave(n); }
+};
+
+template <class A, class B>
+FusedVisitor<A, B> fuse(A& a, B& b)
+{
+    return FusedVisitor<A, B>(a, b);
+}
+
+#endif
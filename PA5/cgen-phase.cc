@@ -4,9 +4,12 @@
 #include "cool-io.h"  //includes iostream
 #include "cool-tree.h"
 #include "cgen_gc.h"
+#include "ast-binary.h"
 
 extern int optind;            // for option processing
 extern char *out_filename;    // name of output assembly
+extern int ast_binary;        // the AST comes in the format of ast-binary.h
+extern char *symbol_file;     // -y: symbol table snapshot to start from
 extern Program ast_root;             // root of the abstract syntax tree
 FILE *ast_file = stdin;       // we read the AST from standard input
 extern int ast_yyparse(void); // entry point to the AST parser
@@ -16,12 +19,17 @@ char *curr_filename;
 
 void handle_flags(int argc, char *argv[]);
 
-int main(int argc, char *argv[]) {
+static int phase_main(int argc, char *argv[]) {
   int firstfile_index;
 
   handle_flags(argc,argv);
   firstfile_index = optind;
 
+  if (symbol_file && !load_symbol_tables(symbol_file)) {
+      cerr << "Cannot load symbol table snapshot " << symbol_file << endl;
+      exit(1);
+  }
+
   if (!out_filename && optind < argc) {   // no -o option
       char *dot = strrchr(argv[optind], '.');
       if (dot) *dot = '\0'; // strip off file extension
@@ -34,7 +42,10 @@ int main(int argc, char *argv[]) {
   // Don't touch the output file until we know that earlier phases of the
   // compiler have succeeded.
   //
-  ast_yyparse();
+  if (ast_binary)
+      ast_root = read_binary(ast_file);
+  else
+      ast_yyparse();
 
   if (out_filename) {
       ofstream s(out_filename);
@@ -46,5 +57,13 @@ int main(int argc, char *argv[]) {
   } else {
       ast_root->cgen(cout);
   }
+  return 0;
 }
 
+//
+// Everything runs on a stack deep enough for deeply nested programs;
+// see run_on_ast_stack in tree.h.
+//
+int main(int argc, char *argv[]) {
+  return run_on_ast_stack(phase_main, argc, argv);
+}
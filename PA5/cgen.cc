@@ -26,6 +26,7 @@
 #include <vector>
 #include <algorithm>
 #include <map>
+#include <set>
 #include <stack>
 
 #include "cgen.h"
@@ -450,7 +451,7 @@ void StrTable::code_string_table(ostream& s, int stringclasstag)
 //
 void IntEntry::code_ref(ostream &s)
 {
-  s << INTCONST_PREFIX << index;
+  s << INTCONST_PREFIX << canon->index;   // 同一个值共用一个 int_const
 }
 
 //
@@ -468,7 +469,11 @@ void IntEntry::code_def(ostream &s, int intclasstag)
       << WORD;
   s << Int << DISPTAB_SUFFIX;
   s << endl;        // 确保这里只有一个 WORD 
-  s << WORD << str << endl;                           
+  s << WORD;
+  if (exact)
+    s << value << endl;
+  else
+    s << str << endl;
 }
 
 
@@ -481,7 +486,8 @@ void IntEntry::code_def(ostream &s, int intclasstag)
 void IntTable::code_string_table(ostream &s, int intclasstag)
 {
   for (List<IntEntry> *l = tbl; l; l = l->tl())
-    l->hd()->code_def(s,intclasstag);
+    if (l->hd()->get_canon() == l->hd())   // 其他写法的同值常量不再单独生成
+      l->hd()->code_def(s,intclasstag);
 }
 
 
@@ -706,15 +712,47 @@ void CgenClassTable::code_dispatchTabs() {
 }
 std::vector<CgenNode*> CgenClassTable::GetClassNodes() {
     if (m_class_nodes.empty()) {
+        // tag 按继承树的 DFS 先序给 (子类按安装顺序走), 每个类的子孙的 tag 都连在一起.
+        // 规则和 semant 里 ClassTable::number_classes 一样, 但没法直接拿它的:
+        // cgen 可以是单独的一趟 (cgen-phase 从 AST 读进来), 那时根本没有 semant
+        // 的表, 所以这里自己再编一遍; 两边的编号也不要求相同, cgen 只用自己这份
+        std::vector<CgenNode*> installed;
         for (List<CgenNode> *l = nds; l; l = l->tl()) {
-            CgenNode* class_node = l->hd();
+            installed.push_back(l->hd());
+        }
+        std::reverse(installed.begin(), installed.end());
+
+        std::set<CgenNode*> visited;
+        std::vector<CgenNode*> todo = { probe(Object) };
+        while (!todo.empty()) {
+            CgenNode* class_node = todo.back();
+            todo.pop_back();
+            if (!visited.insert(class_node).second) continue;
             m_class_nodes.push_back(class_node);
+            std::vector<CgenNode*> children = class_node->GetChildren();
+            for (int i = children.size() - 1; i >= 0; --i) {
+                todo.push_back(children[i]);
+            }
         }
-        std::reverse(m_class_nodes.begin(), m_class_nodes.end());
+        // 从 Object 走不到的类 (继承有环) 也得有 tag, 排在最后
+        for (CgenNode* class_node : installed) {
+            if (visited.insert(class_node).second) m_class_nodes.push_back(class_node);
+        }
+
         for (int i = 0; i < m_class_nodes.size(); ++i) {
             m_class_nodes[i]->class_tag = i;
             m_class_tags.insert(std::make_pair(m_class_nodes[i]->get_name(), i));
         }
+        // 倒着扫, 子类总是在父类后面, 算到父类时子类的 last_tag 已经有了
+        for (int i = m_class_nodes.size() - 1; i >= 0; --i) {
+            CgenNode* class_node = m_class_nodes[i];
+            class_node->last_tag = i;
+            for (CgenNode* child : class_node->GetChildren()) {
+                if (child->class_tag > i) {
+                    class_node->last_tag = std::max(class_node->last_tag, child->last_tag);
+                }
+            }
+        }
     }
 
     return m_class_nodes;
@@ -1366,7 +1404,7 @@ CgenNode::CgenNode(Class_ nd, Basicness bstatus, CgenClassTableP ct) :
 //
 //*****************************************************************
 
-void assign_class::code(ostream &s, Environment env) {
+void assign_class::code(ostream &s, Environment& env) {
     // 1. 首先计算右侧表达式的值，结果存入 $a0
     s << "\t# Assign: evaluating expr" << endl;
     expr->code(s, env);
@@ -1405,11 +1443,11 @@ else if ((idx = env.LookUpAttrib(name)) != -1) {
 
 // cgen.cc：整段替换 static_dispatch_class::code
 // cgen.cc：整段替换 static_dispatch_class::code
-void static_dispatch_class::code(ostream& s, Environment env) {
+void static_dispatch_class::code(ostream& s, Environment& env) {
+    EnvironmentGuard guard(env);
     s << "\t# Static dispatch. First eval and save the params." << endl;
 
     std::vector<Expression> actuals = GetActuals();
-    Environment new_env = env;
     for (Expression expr : actuals) {
         expr->code(s, env);
         emit_push(ACC, s);
@@ -1451,7 +1489,8 @@ void static_dispatch_class::code(ostream& s, Environment env) {
 
 }
 
-void dispatch_class::code(ostream& s, Environment env) {
+void dispatch_class::code(ostream& s, Environment& env) {
+    EnvironmentGuard guard(env);
     s << "\t# Dispatch. First eval and save the params." << endl;
     std::vector<Expression> actuals = GetActuals();
 
@@ -1500,7 +1539,7 @@ void dispatch_class::code(ostream& s, Environment env) {
 
 
 
-void cond_class::code(ostream& s, Environment env) {
+void cond_class::code(ostream& s, Environment& env) {
     s << "\t# If statement. First eval condition." << endl;
     pred->code(s, env);
 
@@ -1533,7 +1572,7 @@ void cond_class::code(ostream& s, Environment env) {
 }
 
 
-void loop_class::code(ostream& s, Environment env) {
+void loop_class::code(ostream& s, Environment& env) {
     int start = labelnum;
     int finish = labelnum + 1;
     labelnum += 2;
@@ -1572,7 +1611,8 @@ void loop_class::code(ostream& s, Environment env) {
 // =========================
 // cgen.cc：整段替换 typcase_class::code
 // =========================
-void typcase_class::code(ostream& s, Environment env) {
+void typcase_class::code(ostream& s, Environment& env) {
+    EnvironmentGuard guard(env);
     std::map<Symbol, int> _class_tags = codegen_classtable->GetClassTags();
     std::vector<CgenNode*> _class_nodes = codegen_classtable->GetClassNodes();
     
@@ -1598,56 +1638,25 @@ void typcase_class::code(ostream& s, Environment env) {
     int caseidx = 0;
     labelnum += _cases.size() + 1;
 
-    auto GetChildrenTagsSet = [&](std::vector<int> __curr_tags) {
-        std::vector<int> __children_tags; // for return.
-        for (int __curr_tag : __curr_tags) { // find children of this class.
-            CgenNode* __curr_node = _class_nodes[__curr_tag];
-            std::vector<CgenNode*> __children_nodes = __curr_node->GetChildren();
-            for (CgenNode* __children_node : __children_nodes) {
-                int __children_tag = _class_tags[__children_node->name];
-                if (std::find(__children_tags.begin(), __children_tags.end(), __children_tag) == __children_tags.end()) {
-                    __children_tags.push_back(__children_tag);
-                }
-            }
-        }
-        return __children_tags;
-    };
-
-    auto HasFinished = [&](std::vector<std::vector<int> > __cases_tags) {
-        for (std::vector<int> __case_tags : __cases_tags) {
-            if (!__case_tags.empty()) {
-                return false;
-            }
-        }
-        return true;
-    };
-
-    // Generate first round cases_tags.
-    std::vector<std::vector<int> > cases_tags;
-    for (branch_class* _case : _cases) {
-        Symbol _type_decl = _case->type_decl;
-        int _class_tag = _class_tags[_type_decl];
-        std::vector<int> case_tags = { _class_tag };
-        cases_tags.push_back(case_tags);
+    // 每个分支一次区间判断. 分支按 tag 从大到小排: 先序编号里子孙的 tag 比祖先大,
+    // 所以第一个 [class_tag, last_tag] 包住 T1 的分支就是离动态类型最近的那个
+    std::vector<int> order;
+    for (size_t i = 0; i < _cases.size(); ++i) {
+        if (_class_tags.count(_cases[i]->type_decl)) order.push_back(i);
     }
-
-    while (!HasFinished(cases_tags)) {
-        // Print cases_tags.
-        for (int caseidx = 0; caseidx < cases_tags.size(); ++caseidx) {
-            std::vector<int> case_tags = cases_tags[caseidx];
-            for (int case_tag : case_tags) {
-                s << "\t# tag = " << case_tag << " : goto case " << caseidx << endl;
-                emit_load_imm(T2, case_tag, s);
-                emit_beq(T1, T2, labelbeg + caseidx, s);
-                s << endl;
-            }
-            
-        }
-        s << "\t# ----------------" << endl;
-
-        for (int i = 0; i < cases_tags.size(); ++i) {
-            cases_tags[i] = GetChildrenTagsSet(cases_tags[i]);
-        }
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        return _class_tags[_cases[a]->type_decl] > _class_tags[_cases[b]->type_decl];
+    });
+
+    for (int i : order) {
+        CgenNode* _case_node = _class_nodes[_class_tags[_cases[i]->type_decl]];
+        s << "\t# tag in [" << _case_node->class_tag << ", " << _case_node->last_tag
+          << "] : goto case " << i << endl;
+        emit_blti(T1, _case_node->class_tag, labelnum, s);
+        emit_bgti(T1, _case_node->last_tag, labelnum, s);
+        emit_branch(labelbeg + i, s);
+        emit_label_def(labelnum, s);
+        ++labelnum;
     }
 
     s << "\t# No match" << endl;
@@ -1681,7 +1690,7 @@ void typcase_class::code(ostream& s, Environment env) {
 
 
 
-void block_class::code(ostream &s, Environment env) {
+void block_class::code(ostream &s, Environment& env) {
     for (int i = body->first(); body->more(i); i = body->next(i)) {
         body->nth(i)->code(s, env);
     }
@@ -1694,7 +1703,8 @@ void block_class::code(ostream &s, Environment env) {
 // =========================
 // cgen.cc：整段替换 let_class::code
 // =========================
-void let_class::code(ostream& s, Environment env) {
+void let_class::code(ostream& s, Environment& env) {
+    EnvironmentGuard guard(env);
     s << "\t# Let expr" << endl;
     s << "\t# First eval init" << endl;
     init->code(s, env);
@@ -1731,7 +1741,8 @@ void let_class::code(ostream& s, Environment env) {
 
 
 
-void plus_class::code(ostream& s, Environment env) {
+void plus_class::code(ostream& s, Environment& env) {
+    EnvironmentGuard guard(env);
     s << "\t# Int operation : Add" << endl;
     s << "\t# First eval e1 and push." << endl;
     e1->code(s, env);
@@ -1764,7 +1775,8 @@ void plus_class::code(ostream& s, Environment env) {
 
 
 
-void sub_class::code(ostream& s, Environment env) {
+void sub_class::code(ostream& s, Environment& env) {
+    EnvironmentGuard guard(env);
     s << "\t# Int operation : Sub" << endl;
     s << "\t# First eval e1 and push." << endl;
     e1->code(s, env);
@@ -1795,7 +1807,8 @@ void sub_class::code(ostream& s, Environment env) {
 
 }
 
-void mul_class::code(ostream& s, Environment env) {
+void mul_class::code(ostream& s, Environment& env) {
+    EnvironmentGuard guard(env);
     s << "\t# Int operation : Mul" << endl;
     s << "\t# First eval e1 and push." << endl;
     e1->code(s, env);
@@ -1825,7 +1838,8 @@ void mul_class::code(ostream& s, Environment env) {
     s << endl;
 }
 
-void divide_class::code(ostream& s, Environment env) {
+void divide_class::code(ostream& s, Environment& env) {
+    EnvironmentGuard guard(env);
     s << "\t# Int operation : Div" << endl;
     s << "\t# First eval e1 and push." << endl;
     e1->code(s, env);
@@ -1856,7 +1870,7 @@ void divide_class::code(ostream& s, Environment env) {
 
 }
 
-void neg_class::code(ostream& s, Environment env) {
+void neg_class::code(ostream& s, Environment& env) {
     s << "\t# Neg" << endl;
     s << "\t# Eval e1 and make a copy for result" << endl;
     e1->code(s, env);
@@ -1870,7 +1884,8 @@ void neg_class::code(ostream& s, Environment env) {
 
 }
 
-void lt_class::code(ostream& s, Environment env) {
+void lt_class::code(ostream& s, Environment& env) {
+    EnvironmentGuard guard(env);
     s << "\t# Int operation : Less than" << endl;
     s << "\t# First eval e1 and push." << endl;
     e1->code(s, env);
@@ -1904,7 +1919,8 @@ void lt_class::code(ostream& s, Environment env) {
     ++labelnum;
 }
 
-void eq_class::code(ostream& s, Environment env) {
+void eq_class::code(ostream& s, Environment& env) {
+    EnvironmentGuard guard(env);
     s << "\t# equal" << endl;
     s << "\t# First eval e1 and push." << endl;
     e1->code(s, env);
@@ -1939,7 +1955,8 @@ void eq_class::code(ostream& s, Environment env) {
     ++labelnum;
 }
 
-void leq_class::code(ostream& s, Environment env) {
+void leq_class::code(ostream& s, Environment& env) {
+    EnvironmentGuard guard(env);
     s << "\t# Int operation : Less or equal" << endl;
     s << "\t# First eval e1 and push." << endl;
     e1->code(s, env);
@@ -1975,7 +1992,7 @@ void leq_class::code(ostream& s, Environment env) {
 
 // COOL 的 not 运算：comp
 // 规则：e1 先算出 Bool 对象放在 ACC，然后取出 Bool.val (0/1)，再返回相反的 Bool 常量对象
-void comp_class::code(ostream& s, Environment env) {
+void comp_class::code(ostream& s, Environment& env) {
     s << "\t# the 'not' operator" << endl;
     s << "\t# First eval the bool" << endl;
     e1->code(s, env);
@@ -2001,23 +2018,23 @@ void comp_class::code(ostream& s, Environment env) {
 
 
 
-void int_const_class::code(ostream &s, Environment env)
+void int_const_class::code(ostream &s, Environment& env)
 {
   // Need to be sure we have an IntEntry *, not an arbitrary Symbol
   emit_load_int(ACC, inttable.lookup_string(token->get_string()), s);
 }
 
-void string_const_class::code(ostream &s, Environment env)
+void string_const_class::code(ostream &s, Environment& env)
 {
   emit_load_string(ACC, stringtable.lookup_string(token->get_string()), s);
 }
 
-void bool_const_class::code(ostream &s, Environment env)
+void bool_const_class::code(ostream &s, Environment& env)
 {
   emit_load_bool(ACC, BoolConst(val), s);
 }
 
-void new__class::code(ostream& s, Environment env) {
+void new__class::code(ostream& s, Environment& env) {
     if (type_name == SELF_TYPE) {
         emit_load_address(T1, "class_objTab", s);
 
@@ -2067,7 +2084,7 @@ void new__class::code(ostream& s, Environment env) {
 }
 
 
-void isvoid_class::code(ostream& s, Environment env) {
+void isvoid_class::code(ostream& s, Environment& env) {
     e1->code(s, env);
 
     s << "\t# t1 = acc" << endl;
@@ -2092,13 +2109,13 @@ void isvoid_class::code(ostream& s, Environment env) {
 
 
 
-void no_expr_class::code(ostream &s, Environment env) {
+void no_expr_class::code(ostream &s, Environment& env) {
     // no_expr 在 codegen 中一般表示“什么都不生成”，但为了安全让 ACC=0
     emit_move(ACC, ZERO, s);
 }
 
 
-void object_class::code(ostream& s, Environment env) {
+void object_class::code(ostream& s, Environment& env) {
     s << "\t# Object:" << endl;
     int idx;
 
@@ -140,6 +140,7 @@ public:
     std::vector<CgenNode*> inheritance;
 
     int class_tag;
+    int last_tag;    // 子树里最大的 tag: 子类的 tag 正好是 [class_tag, last_tag]
 };
 
 class BoolConst
@@ -213,4 +214,28 @@ public:
     std::vector<Symbol> m_param_idx_tab;
     CgenNode* m_class_node;
 
+};
+
+// code() gets the Environment by reference, so that nesting does not
+// copy it at every level.  A code() that adds scopes or vars puts an
+// EnvironmentGuard first; it puts env back as it was on return.
+class EnvironmentGuard {
+public:
+    EnvironmentGuard(Environment& env)
+        : m_env(env),
+          m_scopes(env.m_scope_lengths.size()),
+          m_last_scope(m_scopes ? env.m_scope_lengths.back() : 0),
+          m_vars(env.m_var_idx_tab.size()) {}
+
+    ~EnvironmentGuard() {
+        m_env.m_scope_lengths.resize(m_scopes);
+        if (m_scopes) m_env.m_scope_lengths.back() = m_last_scope;
+        m_env.m_var_idx_tab.resize(m_vars);
+    }
+
+private:
+    Environment& m_env;
+    size_t m_scopes;
+    int m_last_scope;
+    size_t m_vars;
 };
\ No newline at end of file
@@ -7,6 +7,7 @@
 //////////////////////////////////////////////////////////
 
 
+#include <string.h>
 #include "tree.h"
 #include "cool-tree.handcode.h"
 #include "cool-tree.h"
@@ -509,6 +510,58 @@ Cases append_Cases(Cases p1, Cases p2)
    return new append_node<Case>(p1, p2);
 }
 
+///////////////////////////////////////////////////////////////////////////
+//
+// Hash-consing (see tree.h)
+//
+// Constants, new T for a class T, and arithmetic, comparisons, not and
+// isvoid whose operands are shared nodes are shared; their type is the
+// same wherever they appear and they have no side effects beyond those
+// of new.  Object identifiers (whose type depends on the scope),
+// new SELF_TYPE, dispatches and the other expressions are always made
+// afresh, and so is everything above them.
+//
+///////////////////////////////////////////////////////////////////////////
+enum share_tag {
+  SHARE_INT_CONST = 1, SHARE_BOOL_CONST, SHARE_STRING_CONST, SHARE_NEW,
+  SHARE_PLUS, SHARE_SUB, SHARE_MUL, SHARE_DIVIDE, SHARE_NEG,
+  SHARE_LT, SHARE_EQ, SHARE_LEQ, SHARE_COMP, SHARE_ISVOID
+};
+
+template <class Node, class Field>
+static Expression shared_leaf(int tag, Field f)
+{
+  const void *a = (const void *) (size_t) f;
+  tree_node *t = find_shared(tag, a, NULL);
+  if (t)
+    return (Expression) t;
+  Expression e = new Node(f);
+  add_shared(tag, a, NULL, e);
+  return e;
+}
+
+template <class Node>
+static Expression shared_op(int tag, Expression e1)
+{
+  tree_node *t = find_shared(tag, e1, NULL);
+  if (t)
+    return (Expression) t;
+  Expression e = new Node(e1);
+  add_shared(tag, e1, NULL, e);
+  return e;
+}
+
+template <class Node>
+static Expression shared_op(int tag, Expression e1, Expression e2)
+{
+  tree_node *t = find_shared(tag, e1, e2);
+  if (t)
+    return (Expression) t;
+  Expression e = new Node(e1, e2);
+  add_shared(tag, e1, e2, e);
+  return e;
+}
+
 Program program(Classes classes)
 {
   return new program_class(classes);
@@ -581,71 +634,99 @@ Expression let(Symbol identifier, Symbol type_decl, Expression init, Expression
 
 Expression plus(Expression e1, Expression e2)
 {
+  if (hash_cons_ast && shared_id(e1) && shared_id(e2))
+    return shared_op<plus_class>(SHARE_PLUS, e1, e2);
   return new plus_class(e1, e2);
 }
 
 Expression sub(Expression e1, Expression e2)
 {
+  if (hash_cons_ast && shared_id(e1) && shared_id(e2))
+    return shared_op<sub_class>(SHARE_SUB, e1, e2);
   return new sub_class(e1, e2);
 }
 
 Expression mul(Expression e1, Expression e2)
 {
+  if (hash_cons_ast && shared_id(e1) && shared_id(e2))
+    return shared_op<mul_class>(SHARE_MUL, e1, e2);
   return new mul_class(e1, e2);
 }
 
 Expression divide(Expression e1, Expression e2)
 {
+  if (hash_cons_ast && shared_id(e1) && shared_id(e2))
+    return shared_op<divide_class>(SHARE_DIVIDE, e1, e2);
   return new divide_class(e1, e2);
 }
 
 Expression neg(Expression e1)
 {
+  if (hash_cons_ast && shared_id(e1))
+    return shared_op<neg_class>(SHARE_NEG, e1);
   return new neg_class(e1);
 }
 
 Expression lt(Expression e1, Expression e2)
 {
+  if (hash_cons_ast && shared_id(e1) && shared_id(e2))
+    return shared_op<lt_class>(SHARE_LT, e1, e2);
   return new lt_class(e1, e2);
 }
 
 Expression eq(Expression e1, Expression e2)
 {
+  if (hash_cons_ast && shared_id(e1) && shared_id(e2))
+    return shared_op<eq_class>(SHARE_EQ, e1, e2);
   return new eq_class(e1, e2);
 }
 
 Expression leq(Expression e1, Expression e2)
 {
+  if (hash_cons_ast && shared_id(e1) && shared_id(e2))
+    return shared_op<leq_class>(SHARE_LEQ, e1, e2);
   return new leq_class(e1, e2);
 }
 
 Expression comp(Expression e1)
 {
+  if (hash_cons_ast && shared_id(e1))
+    return shared_op<comp_class>(SHARE_COMP, e1);
   return new comp_class(e1);
 }
 
 Expression int_const(Symbol token)
 {
+  if (hash_cons_ast)
+    return shared_leaf<int_const_class>(SHARE_INT_CONST, token);
   return new int_const_class(token);
 }
 
 Expression bool_const(Boolean val)
 {
+  if (hash_cons_ast)
+    return shared_leaf<bool_const_class>(SHARE_BOOL_CONST, val);
   return new bool_const_class(val);
 }
 
 Expression string_const(Symbol token)
 {
+  if (hash_cons_ast)
+    return shared_leaf<string_const_class>(SHARE_STRING_CONST, token);
   return new string_const_class(token);
 }
 
 Expression new_(Symbol type_name)
 {
+  if (hash_cons_ast && strcmp(type_name->get_string(), "SELF_TYPE") != 0)
+    return shared_leaf<new__class>(SHARE_NEW, type_name);
   return new new__class(type_name);
 }
 
 Expression isvoid(Expression e1)
 {
+  if (hash_cons_ast && shared_id(e1))
+    return shared_op<isvoid_class>(SHARE_ISVOID, e1);
   return new isvoid_class(e1);
 }
 
@@ -9,10 +9,54 @@
 #include "tree.h"
 #include "cool.h"
 #include "stringtab.h"
+#include "symtab.h"
 #define yylineno curr_lineno;
 extern int yylineno;
 
 class Environment;
+class AstWriter;
+class CompactAst;
+typedef unsigned int AstRef;    // see ast-compact.h
+
+//
+// The kinds of node.  Every node's kind() returns its tag; ast-binary,
+// ast-compact and ast-visitor.h all go by these.
+//
+enum AstTag {
+    AST_PROGRAM = 1,
+    AST_CLASS,
+    AST_METHOD,
+    AST_ATTR,
+    AST_FORMAL,
+    AST_BRANCH,
+    AST_ASSIGN,
+    AST_STATIC_DISPATCH,
+    AST_DISPATCH,
+    AST_COND,
+    AST_LOOP,
+    AST_TYPCASE,
+    AST_BLOCK,
+    AST_LET,
+    AST_PLUS,
+    AST_SUB,
+    AST_MUL,
+    AST_DIVIDE,
+    AST_NEG,
+    AST_LT,
+    AST_EQ,
+    AST_LEQ,
+    AST_COMP,
+    AST_INT_CONST,
+    AST_BOOL_CONST,
+    AST_STRING_CONST,
+    AST_NEW,
+    AST_ISVOID,
+    AST_NO_EXPR,
+    AST_OBJECT
+};
+
+// kind() of a node class, for the <class>_EXTRAS below
+#define KIND_EXTRAS(tag) AstTag kind() { return tag; }
 
 inline Boolean copy_Boolean(Boolean b) {return b; }
 inline void assert_Boolean(Boolean) {}
@@ -48,65 +92,150 @@ typedef list_node<Case> Cases_class;
 typedef Cases_class *Cases;
 
 #define Program_EXTRAS                          \
+virtual AstTag kind() = 0;                \
+virtual void semant() = 0;			\
 virtual void cgen(ostream&) = 0;		\
-virtual void dump_with_types(ostream&, int) = 0; 
+virtual void dump_with_types(ostream&, int) = 0; \
+virtual void dump_binary(AstWriter&) = 0; \
+virtual AstRef to_compact(CompactAst&) = 0;
 
 
 
 #define program_EXTRAS                          \
+KIND_EXTRAS(AST_PROGRAM)                          \
+void semant();     				\
 void cgen(ostream&);     			\
-void dump_with_types(ostream&, int);            
+void dump_with_types(ostream&, int);            \
+void dump_binary(AstWriter&);                   \
+AstRef to_compact(CompactAst&);
 
 #define Class__EXTRAS                   \
+virtual AstTag kind() = 0;                \
 virtual Symbol get_name() = 0;  	\
 virtual Symbol get_parent() = 0;    	\
 virtual Symbol get_filename() = 0;      \
-virtual void dump_with_types(ostream&,int) = 0; 
+virtual Features get_features() = 0;    \
+virtual void dump_with_types(ostream&,int) = 0; \
+virtual void dump_binary(AstWriter&) = 0; \
+virtual AstRef to_compact(CompactAst&) = 0;
 
 
 #define class__EXTRAS                                  \
+KIND_EXTRAS(AST_CLASS)                          \
 Symbol get_name()   { return name; }		       \
 Symbol get_parent() { return parent; }     	       \
 Symbol get_filename() { return filename; }             \
-void dump_with_types(ostream&,int);                    
+Features get_features() { return features; }           \
+void dump_with_types(ostream&,int);                    \
+void dump_binary(AstWriter&);                   \
+AstRef to_compact(CompactAst&);
 
 
 #define Feature_EXTRAS                                        \
-virtual void dump_with_types(ostream&,int) = 0; 
+virtual AstTag kind() = 0;                \
+virtual void dump_with_types(ostream&,int) = 0;               \
+virtual void dump_binary(AstWriter&) = 0; \
+virtual AstRef to_compact(CompactAst&) = 0;
 
 
 #define Feature_SHARED_EXTRAS                                       \
-void dump_with_types(ostream&,int);    
+void dump_with_types(ostream&,int);                                 \
+void dump_binary(AstWriter&);                   \
+AstRef to_compact(CompactAst&);
+
+#define method_EXTRAS                                         \
+KIND_EXTRAS(AST_METHOD)                          \
+Symbol get_name() { return name; }                             \
+Formals get_formals() { return formals; }                      \
+Symbol get_return_type() { return return_type; }               \
+Expression get_expr() { return expr; }
+
+#define attr_EXTRAS                                           \
+KIND_EXTRAS(AST_ATTR)                          \
+Symbol get_name() { return name; }                             \
+Symbol get_type_decl() { return type_decl; }                   \
+Expression get_init() { return init; }
 
 
 #define Formal_EXTRAS                              \
-virtual void dump_with_types(ostream&,int) = 0;
+virtual AstTag kind() = 0;                \
+virtual void dump_with_types(ostream&,int) = 0;    \
+virtual void dump_binary(AstWriter&) = 0; \
+virtual AstRef to_compact(CompactAst&) = 0;
 
 
 #define formal_EXTRAS                           \
-void dump_with_types(ostream&,int);
+KIND_EXTRAS(AST_FORMAL)                          \
+Symbol get_name() { return name; }              \
+Symbol get_type_decl() { return type_decl; }    \
+void dump_with_types(ostream&,int);             \
+void dump_binary(AstWriter&);                   \
+AstRef to_compact(CompactAst&);
 
 
 #define Case_EXTRAS                             \
-virtual void dump_with_types(ostream& ,int) = 0;
+virtual AstTag kind() = 0;                \
+virtual void dump_with_types(ostream& ,int) = 0; \
+virtual void dump_binary(AstWriter&) = 0; \
+virtual AstRef to_compact(CompactAst&) = 0;
 
 
 #define branch_EXTRAS                                   \
-void dump_with_types(ostream& ,int);
+KIND_EXTRAS(AST_BRANCH)                          \
+Symbol get_name() { return name; }                      \
+Symbol get_type_decl() { return type_decl; }            \
+Expression get_expr() { return expr; }                  \
+void dump_with_types(ostream& ,int);                    \
+void dump_binary(AstWriter&);                   \
+AstRef to_compact(CompactAst&);
 
 
 #define Expression_EXTRAS                    \
+virtual AstTag kind() = 0;                \
 Symbol type;                                 \
 Symbol get_type() { return type; }           \
 Expression set_type(Symbol s) { type = s; return this; } \
-virtual void code(ostream&, Environment) = 0; \
+virtual Symbol tc(class ClassTable* ct, Symbol current_class,          \
+                SymbolTable<Symbol, Symbol>* obj_env) = 0;           \
+virtual void code(ostream&, Environment&) = 0; \
 virtual void dump_with_types(ostream&,int) = 0;  \
+virtual void dump_binary(AstWriter&) = 0;    \
+virtual AstRef to_compact(CompactAst&) = 0;  \
 void dump_type(ostream&, int);               \
 Expression_class() { type = (Symbol) NULL; }
 
 #define Expression_SHARED_EXTRAS           \
-void code(ostream&, Environment); 			   \
-void dump_with_types(ostream&,int); 
-
+Symbol tc(class ClassTable* ct, Symbol current_class, \
+          SymbolTable<Symbol, Symbol>* obj_env); \
+void code(ostream&, Environment&);			   \
+void dump_with_types(ostream&,int); \
+void dump_binary(AstWriter&);                   \
+AstRef to_compact(CompactAst&);
+
+
+#define assign_EXTRAS            KIND_EXTRAS(AST_ASSIGN)
+#define static_dispatch_EXTRAS   KIND_EXTRAS(AST_STATIC_DISPATCH)
+#define dispatch_EXTRAS          KIND_EXTRAS(AST_DISPATCH)
+#define cond_EXTRAS              KIND_EXTRAS(AST_COND)
+#define loop_EXTRAS              KIND_EXTRAS(AST_LOOP)
+#define typcase_EXTRAS           KIND_EXTRAS(AST_TYPCASE)
+#define block_EXTRAS             KIND_EXTRAS(AST_BLOCK)
+#define let_EXTRAS               KIND_EXTRAS(AST_LET)
+#define plus_EXTRAS              KIND_EXTRAS(AST_PLUS)
+#define sub_EXTRAS               KIND_EXTRAS(AST_SUB)
+#define mul_EXTRAS               KIND_EXTRAS(AST_MUL)
+#define divide_EXTRAS            KIND_EXTRAS(AST_DIVIDE)
+#define neg_EXTRAS               KIND_EXTRAS(AST_NEG)
+#define lt_EXTRAS                KIND_EXTRAS(AST_LT)
+#define eq_EXTRAS                KIND_EXTRAS(AST_EQ)
+#define leq_EXTRAS               KIND_EXTRAS(AST_LEQ)
+#define comp_EXTRAS              KIND_EXTRAS(AST_COMP)
+#define int_const_EXTRAS         KIND_EXTRAS(AST_INT_CONST)
+#define bool_const_EXTRAS        KIND_EXTRAS(AST_BOOL_CONST)
+#define string_const_EXTRAS      KIND_EXTRAS(AST_STRING_CONST)
+#define new__EXTRAS              KIND_EXTRAS(AST_NEW)
+#define isvoid_EXTRAS            KIND_EXTRAS(AST_ISVOID)
+#define no_expr_EXTRAS           KIND_EXTRAS(AST_NO_EXPR)
+#define object_EXTRAS            KIND_EXTRAS(AST_OBJECT)
 
 #endif
@@ -0,0 +1 @@
+../PA3/cool.y
\ No newline at end of file
@@ -0,0 +1,256 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//  coolc-phase.cc
+//
+//  Single-process compiler driver.  Links the flex scanner, the bison
+//  parser, the semantic checker and the code generator into one binary
+//  and hands the in-memory AST from one phase to the next, instead of
+//  dumping it as text between ./lexer | ./parser | ./semant | ./cgen
+//  the way mycoolc does.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
+#include <vector>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+#include "cool-io.h"  //includes iostream
+#include "cool-tree.h"
+#include "cgen_gc.h"
+#include "ast-binary.h"
+#include "ast-compact.h"
+#include "ast-visitor.h"
+#include "lazy-body.h"
+
+char *curr_filename = "<stdin>";
+FILE *fin;                    // the file the lexer reads from
+
+//
+// The lexer keeps this up to date with the line number of the current
+// line; it is defined by the parser, which uses it as cool_yylloc.
+//
+extern int curr_lineno;
+extern int optind;            // for option processing
+extern char *out_filename;    // name of output assembly
+extern int ast_binary;        // stop after semant and write a binary AST
+extern FILE *yyout;           // where the scanner's default rule echoes
+extern int ast_compact;       // -C: round-trip the AST through ast-compact.h
+extern char *symbol_file;     // -y: symbol table snapshot to start from
+extern Program ast_root;      // root of the abstract syntax tree
+extern Classes parse_results; // classes of the last file parsed
+extern int omerrs;            // a count of lex and parse errors
+
+extern int cool_yyparse();    // entry point to the parser
+extern void cool_lex_file(FILE *);  // points the scanner at a new file
+
+void handle_flags(int argc, char *argv[]);
+
+//
+// Lex and parse one source file, appending its classes to `classes'.
+// The scanner is restarted on every file so that it does not carry
+// buffered input or an EOF state over from the previous one; regular
+// files are scanned in place from a mapping (see cool.flex).
+//
+static Classes parse_file(char *filename, Classes classes)
+{
+  int errs_before = omerrs;
+
+  curr_filename = filename;
+  curr_lineno = 1;
+  parse_results = NULL;
+  cool_lex_file(fin);
+  cool_yyparse();
+
+  if (omerrs == errs_before && parse_results)
+    classes = append_Classes(classes, parse_results);
+  return classes;
+}
+
+//
+// The names a body dispatches to, with or without `@'.
+//
+class CalledNames : public AstVisitor<CalledNames> {
+public:
+  using AstVisitor<CalledNames>::enter;
+  std::vector<Symbol> names;
+  void enter(dispatch_class *d)        { names.push_back(d->name); }
+  void enter(static_dispatch_class *d) { names.push_back(d->name); }
+};
+
+//
+// With -L, parse the bodies the program can run and leave the rest as
+// the scanner's placeholders (see lazy-body.h).  Which method a
+// dispatch reaches depends on the dynamic type of its receiver, so a
+// name that is dispatched to anywhere in a parsed body makes every
+// method of that name live.  Starting from main and the attribute
+// initializers (any class may be instantiated), bodies are parsed until
+// no new names turn up; a method none of them calls stays unparsed.
+//
+static void parse_live_bodies(Classes classes)
+{
+  std::unordered_map<Symbol, std::vector<method_class *> > methods;
+  std::unordered_set<Symbol> done;
+  CalledNames called;
+
+  for (int i = classes->first(); classes->more(i); i = classes->next(i)) {
+      Features fs = classes->nth(i)->get_features();
+      for (int j = fs->first(); fs->more(j); j = fs->next(j)) {
+	  Feature f = fs->nth(j);
+	  if (f->kind() == AST_METHOD) {
+	      method_class *m = (method_class *) f;
+	      methods[m->name].push_back(m);
+	  } else {
+	      attr_class *a = (attr_class *) f;
+	      a->init = parse_lazy_body(a->init);
+	      called.visit(a->init);
+	  }
+      }
+  }
+
+  called.names.push_back(idtable.add_string("main"));
+  while (!called.names.empty()) {
+      Symbol name = called.names.back();
+      called.names.pop_back();
+      if (!done.insert(name).second)
+	  continue;
+      std::vector<method_class *>& ms = methods[name];
+      for (size_t k = 0; k < ms.size(); k++) {
+	  ms[k]->expr = parse_lazy_body(ms[k]->expr);
+	  called.visit(ms[k]->expr);
+      }
+  }
+}
+
+//
+// With -C the AST is converted to the compact form of ast-compact.h
+// and back before semant and again before cgen, and the phases run on
+// the rebuilt tree.  The rebuilt tree must dump exactly like the
+// original, line numbers and types included.
+//
+static Program compact_round_trip(Program p)
+{
+  CompactAst c;
+  Program q = c.to_tree(to_compact(c, p));
+
+  std::ostringstream before, after;
+  p->dump_with_types(before, 0);
+  q->dump_with_types(after, 0);
+  if (before.str() != after.str()) {
+      cerr << "The AST changed on its way through the compact form\n";
+      exit(2);
+  }
+  return q;
+}
+
+static int phase_main(int argc, char *argv[]) {
+  Classes classes = nil_Classes();
+
+  handle_flags(argc,argv);
+  if (symbol_file && !load_symbol_tables(symbol_file)) {
+      cerr << "Cannot load symbol table snapshot " << symbol_file << endl;
+      exit(1);
+  }
+
+  if (!out_filename && !ast_binary && optind < argc) {   // no -o option
+      char *name = argv[optind];
+      char *dot = strrchr(name, '.');
+      int base = dot ? dot - name : strlen(name);
+      out_filename = new char[base+3];
+      strncpy(out_filename, name, base);
+      strcpy(out_filename + base, ".s");
+  }
+
+  //
+  // When the output goes to stdout (-b, or no input file to name it
+  // after), the text the scanner echoes goes to stderr so that it does
+  // not end up in the AST or the assembly.
+  //
+  if (!out_filename)
+      yyout = stderr;
+
+  if (optind == argc) {
+      fin = stdin;
+      classes = parse_file("<stdin>", classes);
+  }
+  for ( ; optind < argc; optind++) {
+      fin = fopen(argv[optind], "r");
+      if (fin == NULL) {
+	  cerr << "Could not open input file " << argv[optind] << endl;
+	  exit(1);
+      }
+      classes = parse_file(argv[optind], classes);
+      fclose(fin);
+  }
+
+  if (omerrs == 0 && lazy_bodies)
+      parse_live_bodies(classes);
+  if (omerrs != 0) {
+      cerr << "Compilation halted due to lex and parse errors\n";
+      exit(1);
+  }
+
+  //
+  // The parser only builds a program node per file; the phases below
+  // see the classes of every input file under one root.  semant() exits
+  // on static semantic errors, so the output file is only touched once
+  // the program is known to be well-typed.
+  //
+  ast_root = program(classes);
+  if (ast_compact)
+      ast_root = compact_round_trip(ast_root);
+  ast_root->semant();
+  if (ast_compact)
+      ast_root = compact_round_trip(ast_root);
+
+  //
+  // With -b the typed AST is written for a separate `cgen -b' instead
+  // of being compiled here.
+  //
+  if (ast_binary) {
+      if (out_filename) {
+	  ofstream s(out_filename, std::ios::binary);
+	  if (!s) {
+	      cerr << "Cannot open output file " << out_filename << endl;
+	      exit(1);
+	  }
+	  dump_binary(s, ast_root);
+      } else {
+	  dump_binary(cout, ast_root);
+      }
+      return 0;
+  }
+
+  if (out_filename) {
+      ofstream s(out_filename);
+      if (!s) {
+	  cerr << "Cannot open output file " << out_filename << endl;
+	  exit(1);
+      }
+      ast_root->cgen(s);
+  } else {
+      ast_root->cgen(cout);
+  }
+
+  //
+  // The AST is not needed any more; free all of it at once.
+  //
+  release_ast_nodes();
+  return 0;
+}
+
+//
+// Everything runs on a stack deep enough for deeply nested programs;
+// see run_on_ast_stack in tree.h.
+//
+int main(int argc, char *argv[]) {
+  return run_on_ast_stack(phase_main, argc, argv);
+}
@@ -24,13 +24,19 @@
 
 extern int yy_flex_debug;       // for the lexer; prints recognized rules
 extern int cool_yydebug;        // for the parser
+extern int hash_cons_ast;       // share identical subtrees, see tree.h
        int lex_verbose;         // also for the lexer; prints tokens
        int semant_debug;        // for semantic analysis
+       int semant_jobs;         // -j: threads for type checking
        int cgen_debug;          // for code gen
        bool disable_reg_alloc;  // Don't do register allocation
 
        int cgen_optimize;       // optimize switch for code generator 
+       int ast_binary;          // exchange the AST between phases in binary
+       int lazy_bodies;         // coolc -L: parse only the bodies that are used
+       int ast_compact;         // coolc -C: check the compact AST round trip
        char *out_filename;      // file name for generated code
+       char *symbol_file;       // -y: symbol table snapshot to start from
        Memmgr cgen_Memmgr = GC_NOGC;      // enable/disable garbage collection
        Memmgr_Test cgen_Memmgr_Test = GC_NORMAL;  // normal/test GC
        Memmgr_Debug cgen_Memmgr_Debug = GC_QUICK; // check heap frequently
@@ -48,12 +54,16 @@ void handle_flags(int argc, char *argv[]) {
   cool_yydebug = 0;
   lex_verbose  = 0;
   semant_debug = 0;
+  semant_jobs = 1;
   cgen_debug = 0;
   cgen_optimize = 0;
   disable_reg_alloc = 0;
+  ast_binary = 0;
+  lazy_bodies = 0;
+  ast_compact = 0;
   
 
-  while ((c = getopt(argc, argv, "lpscvrOo:gtT")) != -1) {
+  while ((c = getopt(argc, argv, "lpscvrOo:gtTbLHCj:y:")) != -1) {
     switch (c) {
 #ifdef DEBUG
     case 'l':
@@ -99,6 +109,26 @@ void handle_flags(int argc, char *argv[]) {
     case 'O':  // enable optimization
       cgen_optimize = 1;
       break;
+    case 'j':  // type check on this many threads
+      semant_jobs = atoi(optarg);
+      if (semant_jobs < 1)
+        semant_jobs = 1;
+      break;
+    case 'y':  // start from a symbol table snapshot, see stringtab.h
+      symbol_file = optarg;
+      break;
+    case 'b':  // read/write the AST in the binary format of ast-binary.h
+      ast_binary = 1;
+      break;
+    case 'L':  // parse method bodies on demand, see lazy-body.h
+      lazy_bodies = 1;
+      break;
+    case 'H':  // hash-cons the AST, see tree.h
+      hash_cons_ast = 1;
+      break;
+    case 'C':  // round-trip the AST through ast-compact.h
+      ast_compact = 1;
+      break;
     case '?':
       unknownopt = 1;
       break;
@@ -111,9 +141,9 @@ void handle_flags(int argc, char *argv[]) {
   if (unknownopt) {
       cerr << "usage: " << argv[0] << 
 #ifdef DEBUG
-	  " [-lvpscOgtTr -o outname] [input-files]\n";
+	  " [-lvpscOgtTrbLHC -o outname -j jobs -y symbols] [input-files]\n";
 #else
-      " [-OgtT -o outname] [input-files]\n";
+      " [-OgtTbLHC -o outname -j jobs -y symbols] [input-files]\n";
 #endif
       exit(1);
   }
@@ -0,0 +1 @@
+../PA2/lazy-body.h
\ No newline at end of file
@@ -0,0 +1 @@
+../PA2/relex.h
\ No newline at end of file
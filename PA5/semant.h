@@ -0,0 +1 @@
+../PA4/semant.h
\ No newline at end of file
@@ -5,6 +5,11 @@
 #include "copyright.h"
 
 #include <assert.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "stringtab_functions.h"
 #include "stringtab.h"
 
@@ -18,17 +23,27 @@ template class StringTable<IdEntry>;
 template class StringTable<StringEntry>;
 template class StringTable<IntEntry>;
 
-Entry::Entry(char *s, int l, int i) : len(l), index(i) {
-  str = new char [len+1];
-  strncpy(str, s, len);
-  str[len] = '\0';
+unsigned int hash_string(char *s, int len)
+{
+  unsigned int h = 2166136261u;
+  for (int i = 0; i < len; i++)
+    h = (h ^ (unsigned char) s[i]) * 16777619u;
+  return h;
 }
 
+Entry::Entry(char *s, int l, int i, unsigned int h) :
+  str(s), len(l), index(i), hash(h) { }
+
 int Entry::equal_string(char *string, int length) const
 {
   return (len == length) && (strncmp(str,string,len) == 0);
 }
 
+int Entry::equal_string(char *string, int length, unsigned int h) const
+{
+  return (hash == h) && (len == length) && (strncmp(str,string,len) == 0);
+}
+
 ostream& Entry::print(ostream& s) const
 {
   return s << "{" << str << ", " << len << ", " << index << "}\n";
@@ -70,10 +85,187 @@ void dump_Symbol(ostream& s, int n, Symbol sym)
   s << pad(n) << sym << endl;
 }
 
-StringEntry::StringEntry(char *s, int l, int i) : Entry(s,l,i) { }
-IdEntry::IdEntry(char *s, int l, int i) : Entry(s,l,i) { }
-IntEntry::IntEntry(char *s, int l, int i) : Entry(s,l,i) { }
+StringEntry::StringEntry(char *s, int l, int i, unsigned int h) : Entry(s,l,i,h) { }
+IdEntry::IdEntry(char *s, int l, int i, unsigned int h) : Entry(s,l,i,h) { }
+
+IntEntry::IntEntry(char *s, int l, int i, unsigned int h) :
+  Entry(s,l,i,h), value(0), exact(false), canon(this)
+{
+  int k = (l > 0 && s[0] == '-') ? 1 : 0;
+  long long v = 0;
+
+  if (k == l)
+    return;
+  for ( ; k < l; k++) {
+    if (s[k] < '0' || s[k] > '9' || v > 2147483648LL)
+      return;
+    v = 10 * v + (s[k] - '0');
+  }
+  if (s[0] == '-')
+    v = -v;
+  if (v < -2147483648LL || v > 2147483647LL)
+    return;
+  value = (int) v;
+  exact = true;
+}
+
+//
+// Point a new entry at the first entry with the same value.  Entries
+// whose string is not an int keep their own int_const.
+//
+void IntTable::added(IntEntry *e)
+{
+  if (!e->exact)
+    return;
+  std::unordered_map<int, IntEntry *>::iterator it = values.find(e->value);
+  if (it == values.end())
+    values[e->value] = e;
+  else
+    e->canon = it->second;
+}
+
+IntEntry *IntTable::lookup_int(int i)
+{
+  std::lock_guard<std::mutex> guard(alloc_lock);
+  std::unordered_map<int, IntEntry *>::iterator it = values.find(i);
+  return it == values.end() ? (IntEntry *) NULL : it->second;
+}
+
+IntEntry *IntTable::add_int(int i)
+{
+  IntEntry *e = lookup_int(i);
+  return e ? e : StringTable<IntEntry>::add_int(i)->canon;
+}
+
+//
+// Blocks are ARENA_BLOCK bytes; a request larger than a quarter of that
+// gets its own block so the rest of the current one is not wasted.
+//
+#define ARENA_BLOCK 65536
+#define ARENA_ALIGN(n) (((n) + sizeof(void *) - 1) & ~(sizeof(void *) - 1))
+
+void *StringArena::alloc(size_t size)
+{
+  size = ARENA_ALIGN(size);
+  if (size > ARENA_BLOCK / 4)
+    return malloc(size);
+  if (size > (size_t) (end - next)) {
+    next = (char *) malloc(ARENA_BLOCK);
+    end = next + ARENA_BLOCK;
+  }
+  void *p = next;
+  next += size;
+  return p;
+}
 
 IdTable idtable;
 IntTable inttable;
 StrTable stringtable;
+
+//
+// Symbol table snapshots.  A snapshot is the magic "CSYM" and a version
+// number, followed by idtable, inttable and stringtable as written by
+// StringTable::write.  Numbers are 32 bits in the byte order of the
+// machine that wrote the file; a snapshot is a cache for this compiler,
+// not an exchange format.
+//
+#define SNAPSHOT_MAGIC   "CSYM"
+#define SNAPSHOT_VERSION 1
+
+bool save_symbol_tables(char *filename)
+{
+  FILE *f = fopen(filename, "wb");
+  if (f == NULL)
+    return false;
+
+  unsigned int version = SNAPSHOT_VERSION;
+  fwrite(SNAPSHOT_MAGIC, 1, 4, f);
+  fwrite(&version, 4, 1, f);
+  idtable.write(f);
+  inttable.write(f);
+  stringtable.write(f);
+
+  bool ok = !ferror(f);
+  return fclose(f) == 0 && ok;
+}
+
+//
+// Check the table that starts at p and return where it ends, or NULL if
+// it does not fit before `end' or a string is not terminated.
+//
+static char *check_table(char *p, char *end)
+{
+  unsigned int count;
+
+  if (end - p < 4)
+    return NULL;
+  memcpy(&count, p, 4);
+  p += 4;
+  while (count-- > 0) {
+    unsigned int head[2];
+    if (end - p < 8)
+      return NULL;
+    memcpy(head, p, 8);
+    p += 8;
+    size_t size = head[1] + 4 - head[1] % 4;
+    if ((size_t) (end - p) < size || p[head[1]] != '\0')
+      return NULL;
+    p += size;
+  }
+  return p;
+}
+
+template <class Elem>
+static char *load_table(StringTable<Elem>& table, char *p)
+{
+  unsigned int count;
+
+  memcpy(&count, p, 4);
+  p += 4;
+  while (count-- > 0) {
+    unsigned int head[2];
+    memcpy(head, p, 8);
+    table.add_mapped(p + 8, head[1], head[0]);
+    p += 8 + head[1] + 4 - head[1] % 4;
+  }
+  return p;
+}
+
+//
+// The mapping is never unmapped: the entries point into it.
+//
+bool load_symbol_tables(char *filename)
+{
+  if (idtable.more(0) || inttable.more(0) || stringtable.more(0))
+    return false;
+
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (fstat(fd, &st) < 0 || st.st_size < 8) {
+    close(fd);
+    return false;
+  }
+  char *base = (char *) mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED)
+    return false;
+
+  char *end = base + st.st_size;
+  unsigned int version;
+  memcpy(&version, base + 4, 4);
+  char *p = base + 8;
+  if (memcmp(base, SNAPSHOT_MAGIC, 4) != 0 || version != SNAPSHOT_VERSION ||
+      (p = check_table(p, end)) == NULL ||
+      (p = check_table(p, end)) == NULL ||
+      (p = check_table(p, end)) == NULL) {
+    munmap(base, st.st_size);
+    return false;
+  }
+
+  p = load_table(idtable, base + 8);
+  p = load_table(inttable, p);
+  load_table(stringtable, p);
+  return true;
+}
@@ -0,0 +1 @@
+../PA2/stringtab_functions.h
\ No newline at end of file
@@ -0,0 +1 @@
+../PA2/token-batch.h
\ No newline at end of file
@@ -13,6 +13,11 @@
 //
 ///////////////////////////////////////////////////////////////////////////
 
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
+#include <unordered_map>
 #include "tree.h"
 
 /* line number to assign to the current node being constructed */
@@ -47,3 +52,235 @@ tree_node *tree_node::set(tree_node *t) {
    line_number = t->line_number;
    return this;
 }
+
+///////////////////////////////////////////////////////////////////////////
+//
+// The node arena
+//
+// tree_node::operator new carves nodes out of NODE_BLOCK byte blocks
+// by bumping a pointer.  The blocks are chained together so that
+// release_ast_nodes can free the whole tree in one go.  Trees are only
+// built by one thread at a time (the parser or an AST reader), so the
+// arena has no lock.
+//
+///////////////////////////////////////////////////////////////////////////
+#define NODE_BLOCK (256 * 1024)
+#define NODE_ALIGN 16
+
+struct node_block {
+    node_block *prev;
+};
+
+static node_block *node_blocks = NULL;
+static char *node_next = NULL;       // free space in the newest block
+static char *node_end = NULL;
+
+void *tree_node::operator new(size_t size)
+{
+    size = (size + NODE_ALIGN - 1) & ~(size_t) (NODE_ALIGN - 1);
+    if (size > (size_t) (node_end - node_next)) {
+	size_t bytes = NODE_ALIGN + (size > NODE_BLOCK ? size : NODE_BLOCK);
+	node_block *b = (node_block *) malloc(bytes);
+	if (b == NULL) {
+	    cerr << "out of memory for tree nodes\n";
+	    exit(1);
+	}
+	b->prev = node_blocks;
+	node_blocks = b;
+	node_next = (char *) b + NODE_ALIGN;
+	node_end = (char *) b + bytes;
+    }
+    void *p = node_next;
+    node_next += size;
+    return p;
+}
+
+static void forget_shared();
+
+void release_ast_nodes()
+{
+    while (node_blocks) {
+	node_block *b = node_blocks;
+	node_blocks = b->prev;
+	free(b);
+    }
+    node_next = node_end = NULL;
+    forget_shared();
+}
+
+///////////////////////////////////////////////////////////////////////////
+//
+// The hash-consing table
+//
+// Fields that are subtrees are shared nodes themselves, so comparing
+// the fields' pointers compares the whole subtrees.  Like the arena,
+// the table is only used by the thread building the tree.
+//
+///////////////////////////////////////////////////////////////////////////
+int hash_cons_ast = 0;
+
+struct shared_key {
+    int tag;
+    const void *a, *b;
+    bool operator==(const shared_key& k) const
+        { return tag == k.tag && a == k.a && b == k.b; }
+};
+
+struct shared_key_hash {
+    size_t operator()(const shared_key& k) const
+    {
+	size_t h = (size_t) k.tag;
+	h = h * 0x9e3779b97f4a7c15ULL ^ (size_t) k.a;
+	h = h * 0x9e3779b97f4a7c15ULL ^ (size_t) k.b;
+	return h ^ (h >> 29);
+    }
+};
+
+static std::unordered_map<shared_key, tree_node *, shared_key_hash> shared_nodes;
+static std::unordered_map<tree_node *, int> shared_ids;
+
+tree_node *find_shared(int tag, const void *a, const void *b)
+{
+    shared_key k = { tag, a, b };
+    std::unordered_map<shared_key, tree_node *, shared_key_hash>::iterator
+	i = shared_nodes.find(k);
+    return i == shared_nodes.end() ? NULL : i->second;
+}
+
+void add_shared(int tag, const void *a, const void *b, tree_node *t)
+{
+    shared_key k = { tag, a, b };
+    int id = shared_ids.size() + 1;
+    shared_nodes[k] = t;
+    shared_ids[t] = id;
+}
+
+int shared_id(tree_node *t)
+{
+    if (shared_ids.empty())
+	return 0;
+    std::unordered_map<tree_node *, int>::iterator i = shared_ids.find(t);
+    return i == shared_ids.end() ? 0 : i->second;
+}
+
+int shared_count()
+{
+    return shared_ids.size();
+}
+
+static void forget_shared()
+{
+    shared_nodes.clear();
+    shared_ids.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////
+//
+// run_on_ast_stack
+//
+// The stack is mapped with MAP_NORESERVE, so reserving gigabytes costs
+// nothing until the recursion gets there; its lowest page is left
+// inaccessible as a guard.  If the stack cannot be set up, fn simply
+// runs on the current one.
+//
+///////////////////////////////////////////////////////////////////////////
+
+struct ast_stack_call {
+    int (*fn)(int, char **);
+    int argc;
+    char **argv;
+    int result;
+};
+
+static void *ast_stack_start(void *arg)
+{
+    ast_stack_call *call = (ast_stack_call *) arg;
+    call->result = call->fn(call->argc, call->argv);
+    return NULL;
+}
+
+int run_on_ast_stack(int (*fn)(int, char **), int argc, char **argv)
+{
+    ast_stack_call call = { fn, argc, argv, 0 };
+    size_t size = AST_STACK_SIZE;
+    size_t page = sysconf(_SC_PAGESIZE);
+
+    void *stack = mmap(NULL, size, PROT_READ | PROT_WRITE,
+		       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (stack == MAP_FAILED)
+	return fn(argc, argv);
+    mprotect(stack, page, PROT_NONE);
+
+    pthread_attr_t attr;
+    pthread_t thread;
+    pthread_attr_init(&attr);
+    if (pthread_attr_setstack(&attr, stack, size) != 0 ||
+	pthread_create(&thread, &attr, ast_stack_start, &call) != 0) {
+	pthread_attr_destroy(&attr);
+	munmap(stack, size);
+	return fn(argc, argv);
+    }
+    pthread_attr_destroy(&attr);
+    pthread_join(thread, NULL);
+    munmap(stack, size);
+    return call.result;
+}
+
+///////////////////////////////////////////////////////////////////////////
+//
+// run_on_ast_threads
+//
+// The stacks are mapped the same way as run_on_ast_stack's, one per
+// thread.
+//
+///////////////////////////////////////////////////////////////////////////
+
+struct ast_thread_call {
+    void (*fn)(void *);
+    void *arg;
+};
+
+static void *ast_thread_start(void *arg)
+{
+    ast_thread_call *call = (ast_thread_call *) arg;
+    call->fn(call->arg);
+    return NULL;
+}
+
+void run_on_ast_threads(int n, void (*fn)(void *), void *arg)
+{
+    ast_thread_call call = { fn, arg };
+    size_t size = AST_STACK_SIZE;
+    size_t page = sysconf(_SC_PAGESIZE);
+    void **stacks = new void *[n];
+    pthread_t *threads = new pthread_t[n];
+    int started = 0;
+
+    for (int i = 0; i < n; i++) {
+	void *stack = mmap(NULL, size, PROT_READ | PROT_WRITE,
+			   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (stack == MAP_FAILED)
+	    break;
+	mprotect(stack, page, PROT_NONE);
+
+	pthread_attr_t attr;
+	pthread_attr_init(&attr);
+	if (pthread_attr_setstack(&attr, stack, size) != 0 ||
+	    pthread_create(&threads[started], &attr, ast_thread_start, &call) != 0) {
+	    pthread_attr_destroy(&attr);
+	    munmap(stack, size);
+	    break;
+	}
+	pthread_attr_destroy(&attr);
+	stacks[started++] = stack;
+    }
+
+    if (started < n)
+	fn(arg);
+    for (int i = 0; i < started; i++) {
+	pthread_join(threads[i], NULL);
+	munmap(stacks[i], size);
+    }
+    delete [] stacks;
+    delete [] threads;
+}
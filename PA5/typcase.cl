@@ -0,0 +1,83 @@
+(*
+ *  typcase.cl
+ *
+ *  case 分支的区间判断的回归测试。每个分支是对 tag 的一次区间判断,
+ *  要按 tag 从大到小试, 才能选中离动态类型最近的分支。
+ *
+ *  这里的类故意打乱了顺序来定义 (子类写在父类前面, 兄弟类交错),
+ *  分支也故意从最不具体的写到最具体的, 中间还夹着兄弟类的分支:
+ *
+ *         A
+ *       /   \
+ *      B     C
+ *      |     |
+ *      D     F
+ *      |
+ *      E
+ *
+ *  正确的输出是:
+ *
+ *  A B C D D C IO Object Object
+ *  B F D A
+ *)
+
+class E inherits D {
+};
+
+class F inherits C {
+};
+
+class D inherits B {
+};
+
+class A {
+};
+
+class C inherits A {
+};
+
+class B inherits A {
+};
+
+class Main inherits IO {
+    -- 分支从最不具体的写到最具体的
+    which(x : Object) : String {
+        case x of
+            o : Object => "Object";
+            a : A => "A";
+            c : C => "C";
+            b : B => "B";
+            i : IO => "IO";
+            d : D => "D";
+        esac
+    };
+
+    -- 兄弟子树各走各的分支, 嵌套的子类走最近的祖先
+    leaf(x : A) : String {
+        case x of
+            a : A => "A";
+            d : D => "D";
+            f : F => "F";
+            b : B => "B";
+        esac
+    };
+
+    main() : Object {
+        {
+            out_string(which(new A)).out_string(" ");
+            out_string(which(new B)).out_string(" ");
+            out_string(which(new C)).out_string(" ");
+            out_string(which(new D)).out_string(" ");
+            out_string(which(new E)).out_string(" ");
+            out_string(which(new F)).out_string(" ");
+            out_string(which(self)).out_string(" ");
+            out_string(which(1)).out_string(" ");
+            out_string(which("s")).out_string("\n");
+
+            out_string(leaf(new B)).out_string(" ");
+            out_string(leaf(new F)).out_string(" ");
+            out_string(leaf(new E)).out_string(" ");
+            out_string(leaf(new A)).out_string("\n");
+        }
+    };
+};